@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include "MappedFile.h"
+
+// Сигнатура файла дебютной книги
+const char BOOK_MAGIC[8] = { 'C', 'K', 'B', 'O', 'O', 'K', '1', '\0' };
+
+// Наибольшее количество клеток в записи хода (начальная клетка и клетки после каждого удара серии)
+const int BOOK_MAX_PATH = 11;
+
+// Заголовок файла: сигнатура и количество записей
+struct BookFileHeader {
+    char magic[8];
+    uint64_t count;
+};
+
+// Запись книги: хэш позиции вместе с очередью хода (zobrist_hash с bot_color = 0), вес хода
+// (сколько раз его выбрал перебор при построении) и клетки хода: начальная и конечные клетки каждого шага серии.
+// Записи отсортированы по хэшу, записи одной позиции - по убыванию веса.
+struct BookEntry {
+    uint64_t key;
+    uint32_t weight;
+    uint8_t length;                // Количество клеток в path
+    uint8_t path[BOOK_MAX_PATH];   // Номера клеток (0..31)
+};
+
+static_assert(sizeof(BookFileHeader) == 16 && sizeof(BookEntry) == 24, "Book file layout");
+
+// Класс OpeningBook - дебютная книга, построенная Tools/book_gen.cpp.
+// Файл отображается в память только для чтения, позиция ищется двоичным поиском по хэшу.
+class OpeningBook {
+public:
+    // Открытие файла книги. Возвращает false, если файла нет или он поврежден
+    bool open(const std::string& path) {
+        count = 0;
+        if (!file.open(path))
+            return false;
+        BookFileHeader header;
+        if (file.size() < sizeof(header)) {
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, BOOK_MAGIC, sizeof(header.magic)) != 0 ||
+            file.size() < sizeof(header) + header.count * sizeof(BookEntry)) {
+            file.close();
+            return false;
+        }
+        count = size_t(header.count);
+        return true;
+    }
+
+    // Загружена ли книга
+    bool enabled() const {
+        return count > 0;
+    }
+
+    // Записи позиции с хэшем key (по убыванию веса): номер первой записи в first и количество записей
+    // (0 - позиции нет в книге). Сами записи читаются через entry, без копирования в отдельный список
+    size_t find(const uint64_t key, size_t& first) const {
+        size_t lo = 0, hi = count; // Первая запись с хэшем не меньше key
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (entry(mid).key < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        first = lo;
+        size_t n = 0;
+        while (lo + n < count && entry(lo + n).key == key) {
+            ++n;
+        }
+        return n;
+    }
+
+    // Запись с номером i
+    BookEntry entry(const size_t i) const {
+        BookEntry res;
+        std::memcpy(&res, file.data() + sizeof(BookFileHeader) + i * sizeof(BookEntry), sizeof(res));
+        return res;
+    }
+
+private:
+    MappedFile file;  // Отображенный файл книги
+    size_t count = 0; // Количество записей
+};
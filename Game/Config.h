@@ -7,32 +7,48 @@ using json = nlohmann::json;
 class Config
 {
 public:
-    //   Config.       reload()
-    //      settings.json.
-    Config()
+    // Конструктор класса Config. При создании объекта автоматически вызывает метод reload()
+    // для загрузки настроек из файла settings.json.
+    Config() : path(project_path + "settings.json")
     {
         reload();
     }
 
-    //  reload()     settings.json.
-    //   ,      JSON       config.
-    //      ,       .
+    // Конструктор для загрузки настроек из другого файла в формате settings.json
+    // (например, конфигурации ботов для матчей без окна).
+    explicit Config(const std::string& path) : path(path)
+    {
+        reload();
+    }
+
+    // Метод reload() перезагружает настройки из файла settings.json.
+    // Он открывает файл, считывает его содержимое в формате JSON и сохраняет его в приватную переменную config.
+    // Если файл был изменен или удален, этот метод обеспечивает актуальность данных в программе.
     void reload()
     {
-        std::ifstream fin(project_path + "settings.json"); //   settings.json
-        fin >> config; //      JSON
-        fin.close(); //    
+        std::ifstream fin(path); // Открываем файл настроек
+        fin >> config; // Считываем содержимое файла в объект JSON
+        fin.close(); // Закрываем файл после чтения
     }
 
-    //  () ( )        .
-    //   : setting_dir (/ )  setting_name (  ).
-    //       JSON-.
-    // , config("Bot", "IsWhiteBot")    IsWhiteBot   Bot.
+    // Оператор () (функциональный оператор) позволяет обращаться к настройкам как к элементам структуры.
+    // Принимает два параметра: setting_dir (направление/раздел настроек) и setting_name (имя конкретной настройки).
+    // Возвращает значение настройки из соответствующего раздела JSON-файла.
+    // Например, config("Bot", "IsWhiteBot") вернет значение настройки IsWhiteBot из раздела Bot.
     auto operator()(const std::string& setting_dir, const std::string& setting_name) const
     {
         return config[setting_dir][setting_name];
     }
 
+    // Метод set() меняет настройку только в памяти, не записывая её в settings.json.
+    // Используется инструментами (бенчмарками), которые перебирают значения настроек.
+    template <typename T>
+    void set(const std::string& setting_dir, const std::string& setting_name, const T& value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
 private:
-    json config; //        JSON
+    std::string path; // Путь к файлу настроек
+    json config; // Приватная переменная для хранения настроек в формате JSON
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+// Векторные ядра нейросети и пакетного разбора листьев (LeafBatch.h) есть только для x86: набор инструкций выбирается
+// при запуске по процессору, поэтому программа собирается без -mavx2 и работает на любом x86
+// (на остальных платформах - скалярный код). Функция с ядром помечается EVAL_TARGET("avx2") и т.п.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define EVAL_X86
+#define EVAL_TARGET(isa)
+#include <immintrin.h>
+#include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define EVAL_X86
+#define EVAL_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
+// Набор инструкций для векторных ядер нейросети и разбора листьев
+enum class EvalKernel {
+    SCALAR, // Обычный код
+    SSE41,  // 128-битные регистры
+    AVX2    // 256-битные регистры
+};
+
+// Название набора инструкций (для бенчмарков)
+inline const char* eval_kernel_name(const EvalKernel kernel) {
+    return kernel == EvalKernel::AVX2 ? "avx2" : (kernel == EvalKernel::SSE41 ? "sse4.1" : "scalar");
+}
+
+// Поддерживает ли процессор набор инструкций kernel
+inline bool eval_kernel_supported(const EvalKernel kernel) {
+    if (kernel == EvalKernel::SCALAR)
+        return true;
+#if defined(EVAL_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] >> 19) & 1;
+    if (kernel == EvalKernel::SSE41)
+        return sse41;
+    // AVX2 нужна поддержка и процессора, и системы (сохранение регистров ymm при переключении потоков)
+    const bool os_avx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return os_avx && ((info[1] >> 5) & 1);
+#elif defined(EVAL_X86)
+    return kernel == EvalKernel::AVX2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+// Лучший набор инструкций процессора (определяется один раз)
+inline EvalKernel best_eval_kernel() {
+    static const EvalKernel best = eval_kernel_supported(EvalKernel::AVX2) ? EvalKernel::AVX2 :
+        (eval_kernel_supported(EvalKernel::SSE41) ? EvalKernel::SSE41 : EvalKernel::SCALAR);
+    return best;
+}
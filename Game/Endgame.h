@@ -0,0 +1,258 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+// Наибольшее количество фигур в таблицах окончаний, которое поддерживает формат файла
+const int ENDGAME_MAX_PIECES = 8;
+
+// Сигнатура файла таблиц окончаний
+const char ENDGAME_MAGIC[8] = { 'C', 'K', 'E', 'G', 'T', 'B', '1', '\0' };
+
+// Значения в таблицах (байт на позицию, ход белых):
+// 0 - позиции нет (шашки на одной клетке), 1 - ничья, 2 + d - результат за d полуходов:
+// при нечетном d ходящая сторона выигрывает, при четном - проигрывает (d = 0 - ходов нет)
+const uint8_t ENDGAME_INVALID = 0;
+const uint8_t ENDGAME_DRAW = 1;
+const int ENDGAME_MAX_DISTANCE = 252;
+
+// Результат позиции из таблицы для стороны, которая ходит
+enum class EndgameResult {
+    UNKNOWN, // Позиции нет в таблицах
+    DRAW,
+    WIN,
+    LOSS
+};
+
+// Заголовок файла: сигнатура, наибольшее количество фигур и количество таблиц
+struct EndgameFileHeader {
+    char magic[8];
+    uint32_t max_pieces;
+    uint32_t count;
+};
+
+// Описание одной таблицы в файле: состав фигур (при ходе белых), смещение данных от начала файла и размер
+struct EndgameFileEntry {
+    uint8_t wm, bm, wk, bk; // Белые шашки, черные шашки, белые дамки, черные дамки
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(EndgameFileHeader) == 16 && sizeof(EndgameFileEntry) == 24, "Endgame file layout");
+
+// Биномиальные коэффициенты C(n, k) для нумерации расстановок фигур
+struct Binomials {
+    uint64_t c[33][ENDGAME_MAX_PIECES + 1];
+
+    constexpr Binomials() : c() {
+        for (int n = 0; n <= 32; ++n) {
+            c[n][0] = 1;
+            for (int k = 1; k <= ENDGAME_MAX_PIECES; ++k) {
+                c[n][k] = n ? c[n - 1][k - 1] + c[n - 1][k] : 0;
+            }
+        }
+    }
+};
+
+constexpr Binomials binomials{};
+
+// Номер k-элементного подмножества (маска domain_bits в области из младших битов) в колексикографическом порядке
+inline uint64_t subset_rank(uint32_t domain_bits) {
+    uint64_t rank = 0;
+    for (int i = 1; domain_bits; domain_bits &= domain_bits - 1, ++i) {
+        rank += binomials.c[lsb(domain_bits)][i];
+    }
+    return rank;
+}
+
+// Подмножество из k элементов по его номеру (обратно subset_rank)
+inline uint32_t subset_unrank(uint64_t rank, const int k) {
+    uint32_t res = 0;
+    int s = 31;
+    for (int i = k; i >= 1; --i) {
+        while (binomials.c[s][i] > rank) {
+            --s;
+        }
+        rank -= binomials.c[s][i];
+        res |= uint32_t(1) << s;
+        --s;
+    }
+    return res;
+}
+
+// Номер клетки sq среди свободных клеток free (сжатие области)
+inline int compress_square(const uint32_t free, const int sq) {
+    return popcount(free & ((uint32_t(1) << sq) - 1));
+}
+
+// Клетка с номером idx среди свободных клеток free (обратно compress_square)
+inline int expand_square(uint32_t free, int idx) {
+    for (; idx; --idx) {
+        free &= free - 1;
+    }
+    return lsb(free);
+}
+
+// Нумерация позиций с заданным составом фигур при ходе белых.
+// Белые шашки стоят на клетках 4..31 (на нулевой горизонтали они становятся дамками), черные - на 0..27;
+// дамки нумеруются среди клеток, свободных от шашек. Номера с шашками на одной клетке не используются.
+struct EndgameMaterial {
+    int wm = 0, bm = 0, wk = 0, bk = 0; // Белые шашки, черные шашки, белые дамки, черные дамки
+
+    EndgameMaterial() = default;
+    EndgameMaterial(const int wm, const int bm, const int wk, const int bk) : wm(wm), bm(bm), wk(wk), bk(bk) {
+    }
+
+    // Состав фигур позиции
+    explicit EndgameMaterial(const Position& pos) {
+        wm = popcount(pos.white & ~pos.kings);
+        bm = popcount(pos.black & ~pos.kings);
+        wk = popcount(pos.white & pos.kings);
+        bk = popcount(pos.black & pos.kings);
+    }
+
+    int pieces() const {
+        return wm + bm + wk + bk;
+    }
+
+    // Количество номеров позиций
+    uint64_t size() const {
+        const int men = wm + bm;
+        return binomials.c[28][wm] * binomials.c[28][bm] * binomials.c[32 - men][wk] * binomials.c[32 - men - wk][bk];
+    }
+
+    // Номер позиции pos (состав фигур должен совпадать)
+    uint64_t index(const Position& pos) const {
+        const uint32_t wmen = pos.white & ~pos.kings, bmen = pos.black & ~pos.kings;
+        const uint32_t free1 = ~(wmen | bmen), free2 = free1 & ~(pos.white & pos.kings);
+        uint32_t wkings = 0, bkings = 0; // Дамки в сжатых областях свободных клеток
+        for (uint32_t m = pos.white & pos.kings; m; m &= m - 1) {
+            wkings |= uint32_t(1) << compress_square(free1, lsb(m));
+        }
+        for (uint32_t m = pos.black & pos.kings; m; m &= m - 1) {
+            bkings |= uint32_t(1) << compress_square(free2, lsb(m));
+        }
+        const int men = wm + bm;
+        uint64_t idx = subset_rank(wmen >> 4);
+        idx = idx * binomials.c[28][bm] + subset_rank(bmen);
+        idx = idx * binomials.c[32 - men][wk] + subset_rank(wkings);
+        idx = idx * binomials.c[32 - men - wk][bk] + subset_rank(bkings);
+        return idx;
+    }
+
+    // Позиция по номеру. Возвращает false для неиспользуемых номеров
+    bool position(uint64_t idx, Position& pos) const {
+        const int men = wm + bm;
+        const uint64_t n_bk = binomials.c[32 - men - wk][bk], n_wk = binomials.c[32 - men][wk];
+        const uint64_t n_bm = binomials.c[28][bm];
+        const uint32_t bkings = subset_unrank(idx % n_bk, bk);
+        idx /= n_bk;
+        const uint32_t wkings = subset_unrank(idx % n_wk, wk);
+        idx /= n_wk;
+        const uint32_t bmen = subset_unrank(idx % n_bm, bm);
+        const uint32_t wmen = subset_unrank(idx / n_bm, wm) << 4;
+        if (wmen & bmen)
+            return false;
+        pos = Position();
+        pos.white = wmen;
+        pos.black = bmen;
+        const uint32_t free1 = ~(wmen | bmen);
+        for (uint32_t m = wkings; m; m &= m - 1) {
+            const uint32_t bit = uint32_t(1) << expand_square(free1, lsb(m));
+            pos.white |= bit;
+            pos.kings |= bit;
+        }
+        const uint32_t free2 = free1 & ~pos.kings;
+        for (uint32_t m = bkings; m; m &= m - 1) {
+            const uint32_t bit = uint32_t(1) << expand_square(free2, lsb(m));
+            pos.black |= bit;
+            pos.kings |= bit;
+        }
+        return true;
+    }
+};
+
+// Класс EndgameTable - таблицы окончаний, построенные Tools/endgame_gen.cpp.
+// Файл отображается в память только для чтения и общий для всех потоков перебора.
+class EndgameTable {
+public:
+    // Открытие файла таблиц. Возвращает false, если файла нет или он поврежден
+    bool open(const std::string& path) {
+        tables.assign(TABLES_COUNT, nullptr);
+        pieces = 0;
+        if (!file.open(path))
+            return false;
+        EndgameFileHeader header;
+        if (file.size() < sizeof(header)) {
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, ENDGAME_MAGIC, sizeof(header.magic)) != 0 ||
+            header.max_pieces > ENDGAME_MAX_PIECES ||
+            file.size() < sizeof(header) + uint64_t(header.count) * sizeof(EndgameFileEntry)) {
+            file.close();
+            return false;
+        }
+        for (uint32_t i = 0; i < header.count; ++i) {
+            EndgameFileEntry entry;
+            std::memcpy(&entry, file.data() + sizeof(header) + i * sizeof(entry), sizeof(entry));
+            const EndgameMaterial material(entry.wm, entry.bm, entry.wk, entry.bk);
+            if (material.pieces() > int(header.max_pieces) || entry.size != material.size() ||
+                entry.offset + entry.size > file.size()) {
+                file.close();
+                return false;
+            }
+            tables[table_index(material)] = file.data() + entry.offset;
+        }
+        pieces = int(header.max_pieces);
+        return true;
+    }
+
+    // Загружены ли таблицы
+    bool enabled() const {
+        return pieces > 0;
+    }
+
+    // Наибольшее количество фигур в таблицах
+    int max_pieces() const {
+        return pieces;
+    }
+
+    // Результат позиции pos при ходе color и количество полуходов до конца игры
+    EndgameResult probe(const Position& pos, const bool color, int& distance) const {
+        const Position white_to_move = color ? pos.flipped() : pos;
+        const EndgameMaterial material(white_to_move);
+        if (material.pieces() > pieces || !(pos.white && pos.black))
+            return EndgameResult::UNKNOWN;
+        const uint8_t* table = tables[table_index(material)];
+        if (!table)
+            return EndgameResult::UNKNOWN;
+        const uint8_t value = table[material.index(white_to_move)];
+        if (value == ENDGAME_INVALID)
+            return EndgameResult::UNKNOWN;
+        if (value == ENDGAME_DRAW)
+            return EndgameResult::DRAW;
+        distance = value - 2;
+        return distance % 2 ? EndgameResult::WIN : EndgameResult::LOSS;
+    }
+
+private:
+    static const int TABLES_COUNT = (ENDGAME_MAX_PIECES + 1) * (ENDGAME_MAX_PIECES + 1) *
+        (ENDGAME_MAX_PIECES + 1) * (ENDGAME_MAX_PIECES + 1);
+
+    // Номер таблицы по составу фигур
+    static int table_index(const EndgameMaterial& m) {
+        const int n = ENDGAME_MAX_PIECES + 1;
+        return ((m.wm * n + m.bm) * n + m.wk) * n + m.bk;
+    }
+
+    MappedFile file;                     // Отображенный файл таблиц
+    std::vector<const uint8_t*> tables;  // Начала таблиц в файле по составу фигур
+    int pieces = 0;                      // Наибольшее количество фигур (0 - таблиц нет)
+};
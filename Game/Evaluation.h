@@ -0,0 +1,201 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+#include "Cpu.h"
+#include "Network.h"
+
+// Константа для представления бесконечности в расчетах
+const int INF = 1e9;
+// Предел логарифма оценки нейросети: exp(20) ~ 5e8 меньше INF, поэтому оценка сети не спутается с победой
+const double NN_MAX_LOG = 20;
+
+// Веса материала. Оценка - отношение сумм весов, поэтому важны только отношения весов, а не масштаб.
+// Шашка оценивается по числу пройденных горизонталей (0 - на своей первой горизонтали), дамка - одним весом.
+// Ручные веса - в двадцатых долях шашки: "NumberAndPotential" добавляет 0.05 шашки за горизонталь,
+// "NumberOnly" считает только фигуры (дамка - 4 шашки). Подобранные веса строит Tools/tune.cpp
+struct EvalWeights {
+    int man[8] = { 20, 21, 22, 23, 24, 25, 26, 27 }; // Шашка по пройденным горизонталям
+    int king = 100;                                  // Дамка
+
+    // Ручные веса режима mode
+    static EvalWeights hand_picked(const std::string& mode) {
+        EvalWeights res;
+        if (mode == "NumberOnly") {
+            std::fill(res.man, res.man + 8, 20);
+            res.king = 80;
+        }
+        return res;
+    }
+
+    // Все веса положительны: сумма весов ноль только без фигур (по ней определяется конец партии)
+    bool valid() const {
+        return king > 0 && *std::min_element(man, man + 8) > 0;
+    }
+
+    // Загрузка из файла JSON вида {"Man": [8 весов], "King": вес}. Возвращает false, если файла нет
+    // или веса неверные (тогда веса не меняются)
+    bool load(const std::string& path) {
+        std::ifstream fin(path);
+        if (!fin)
+            return false;
+        const nlohmann::json data = nlohmann::json::parse(fin, nullptr, false);
+        if (data.is_discarded() || !data.is_object() || !data.contains("Man") || !data.contains("King") ||
+            !data["Man"].is_array() || data["Man"].size() != 8 || !data["King"].is_number_integer())
+            return false;
+        EvalWeights res;
+        for (int i = 0; i < 8; ++i) {
+            if (!data["Man"][i].is_number_integer())
+                return false;
+            res.man[i] = data["Man"][i].get<int>();
+        }
+        res.king = data["King"].get<int>();
+        if (!res.valid())
+            return false;
+        *this = res;
+        return true;
+    }
+
+    // Запись в файл JSON (формат load)
+    bool save(const std::string& path) const {
+        const nlohmann::json data = { { "Man", std::vector<int>(man, man + 8) }, { "King", king } };
+        std::ofstream fout(path, std::ios::trunc);
+        fout << data.dump(4) << std::endl;
+        return bool(fout);
+    }
+};
+
+// Число горизонталей, пройденных шашкой цвета color на горизонтали x (белые идут к горизонтали 0, черные - к 7)
+constexpr int man_advance(const bool color, const POS_T x) {
+    return color ? x : 7 - x;
+}
+
+// Слагаемые оценки позиции, которые перебор обновляет при каждом ходе вместо пересчета по всей доске.
+// Индекс - цвет (0 - белые, 1 - черные)
+struct EvalTerms {
+    int material[2] = { 0, 0 };              // Сумма весов фигур (EvalWeights)
+    alignas(32) int16_t acc[NN_HIDDEN] = {}; // Аккумулятор нейросети (только в режиме "NeuralNetwork")
+};
+
+// Класс Evaluator - оценка позиции для листьев дерева перебора в режимах BotScoringType.
+// Слагаемые считаются по всей доске только в корне (init, подсчетом битов масок строк), после каждого хода к ним
+// применяется разность для передвинутой, превращенной и побитой фигуры (update), а оценка листа берется
+// из них за O(1) (score).
+// В режиме "NeuralNetwork" лист оценивает нейросеть (Network), а слагаемые материала только определяют
+// конец партии; аккумулятор сети обновляется ходами так же, как остальные слагаемые.
+class Evaluator {
+public:
+    Evaluator() = default;
+
+    // mode - режим оценки: "NumberOnly", "NumberAndPotential" или "NeuralNetwork" (веса из файла network_file;
+    // если файла нет или он поврежден, оценка - "NumberAndPotential")
+    explicit Evaluator(const std::string& mode, const std::string& network_file = "")
+        : weights(EvalWeights::hand_picked(mode)) {
+        if (mode == "NeuralNetwork") {
+            auto net = std::make_shared<Network>();
+            if (net->open(network_file)) {
+                network = std::move(net);
+            }
+        }
+    }
+
+    // Веса материала (подобранные веса заменяют ручные, должны быть valid)
+    const EvalWeights& get_weights() const {
+        return weights;
+    }
+
+    void set_weights(const EvalWeights& value) {
+        weights = value;
+    }
+
+    // Загружена ли нейросеть
+    bool neural() const {
+        return network != nullptr;
+    }
+
+    // Слагаемые оценки позиции pos
+    EvalTerms init(const Position& pos) const {
+        EvalTerms res;
+        for (int color = 0; color < 2; ++color) {
+            const uint32_t pieces = pos.pieces(color), men = pieces & ~pos.kings;
+            res.material[color] = weights.king * popcount(pieces & pos.kings);
+            for (POS_T x = 0; x < 8; ++x) {
+                res.material[color] += weights.man[man_advance(color, x)] * popcount(men & row_mask(x));
+            }
+        }
+        if (network) { // Аккумулятор сети - сумма столбцов весов всех фигур
+            network->reset(res.acc);
+            for (uint32_t occ = pos.occupied(); occ; occ &= occ - 1) {
+                network->update(res.acc, pos.at(lsb(occ)), lsb(occ), 1, kernel);
+            }
+        }
+        return res;
+    }
+
+    // Изменение слагаемых ev позиции pos после хода turn (pos - позиция до хода)
+    void update(EvalTerms& ev, const Position& pos, const move_pos& turn) const {
+        const POS_T type = pos.at(turn.x, turn.y);
+        if (turn.xb != -1) { // Побитая фигура
+            add_piece(ev, pos.at(turn.xb, turn.yb), turn.xb, turn.yb, -1);
+        }
+        if (type > 2 && !network) { // Дамка: слагаемые материала не меняются
+            return;
+        }
+        add_piece(ev, type, turn.x, turn.y, -1);
+        const bool promotion = (type == 1 && turn.x2 == 0) || (type == 2 && turn.x2 == 7);
+        add_piece(ev, promotion ? POS_T(type + 2) : type, turn.x2, turn.y2, 1);
+    }
+
+    // Оценка для бота цвета first_bot_color: отношение материала бота к материалу соперника,
+    // INF - у соперника нет фигур (победа бота), 0 - у бота нет фигур
+    // (веса целые, поэтому суммы считаются без погрешности).
+    // Нейросеть оценивает логарифм того же отношения, поэтому её оценка - экспонента выхода
+    double score(const EvalTerms& ev, const bool first_bot_color) const {
+        int w = ev.material[0], b = ev.material[1];
+        if (!first_bot_color) { // Оценка всегда считается со стороны бота
+            std::swap(b, w);
+        }
+        if (w == 0) // У соперника не осталось фигур
+            return INF;
+        if (b == 0) // У бота не осталось фигур
+            return 0;
+        if (network) {
+            const double out = network->forward(ev.acc, kernel) / double(NN_QA * NN_QB); // Со стороны белых
+            return std::exp(std::min(std::max(first_bot_color ? -out : out, -NN_MAX_LOG), NN_MAX_LOG));
+        }
+        return double(b) / w;
+    }
+
+    // Набор инструкций нейросети: по умолчанию лучший для процессора, бенчмарк может выбрать
+    // любой поддерживаемый (неподдерживаемый заменяется скалярным кодом)
+    EvalKernel get_kernel() const {
+        return kernel;
+    }
+
+    void set_kernel(const EvalKernel value) {
+        kernel = eval_kernel_supported(value) ? value : EvalKernel::SCALAR;
+    }
+
+private:
+    // Добавление (sign = 1) или удаление (sign = -1) фигуры типа type на клетке (x, y)
+    void add_piece(EvalTerms& ev, const POS_T type, const POS_T x, const POS_T y, const int sign) const {
+        if (network) {
+            network->update(ev.acc, type, cell_to_sq(x, y), sign, kernel);
+        }
+        const int color = (type % 2) ? 0 : 1;
+        ev.material[color] += sign * (type > 2 ? weights.king : weights.man[man_advance(color, x)]);
+    }
+
+    EvalWeights weights;                       // Веса материала
+    EvalKernel kernel = best_eval_kernel();    // Набор инструкций нейросети (и разбора листьев в Logic)
+    std::shared_ptr<const Network> network;    // Веса нейросети (общие для копий, nullptr - эвристика)
+};
@@ -5,210 +5,243 @@
 #include "Board.h"
 #include "Config.h"
 #include "Hand.h"
+#include "Log.h"
 #include "Logic.h"
 
 class Game
 {
 public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&config)
     {
-        //   :   (board),   (hand)    (logic).
-        //    log.txt    .
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
+        // Создание объектов игры: игрового поля (board), управления ходами (hand) и логики игры (logic).
+        // Также открывается журнал игры log.txt (Game/Log.h): файл очищается, строки пишет отдельный поток.
+        game_log().open(project_path + "log.txt", parse_log_level(config("Log", "Level")),
+            config("Log", "MaxSizeKB").get<size_t>() * 1024, config("Log", "Files"));
+
+        // Открываем архив, в который дописываются сыгранные партии (необязателен).
+        const string record_file = config("Game", "RecordFile");
+        if (!record_file.empty())
+            records.open(project_path + record_file);
     }
 
-    //     .
+    // Основная функция для запуска игры.
     int play()
     {
-        auto start = chrono::steady_clock::now(); //        .
+        auto start = chrono::steady_clock::now(); // Запись времени начала игры для расчета общей длительности.
 
         if (is_replay)
         {
-            //    (replay),      .
-            logic = Logic(&board, &config);
-            config.reload(); //     settings.json.
-            board.redraw(); //   .
+            // Если игра повторяется (replay), пересоздаем объект логики и перезагружаем настройки.
+            logic = Logic(&config);
+            config.reload(); // Перезагрузка конфигурации из файла settings.json.
+            board.redraw(); // Перерисовка игрового поля.
         }
         else
         {
-            //    ,     .
+            // Если это новая игра, начинаем рисовать доску с нуля.
             board.start_draw();
         }
 
-        is_replay = false; //    .
-        int turn_num = -1; //    (  -1,     0).
-        bool is_quit = false; //    .
-        const int Max_turns = config("Game", "MaxNumTurns"); //     .
+        is_replay = false; // Сбрасываем флаг повторной игры.
+        int turn_num = -1; // Номер текущего хода (начинается с -1, чтобы первый ход был 0).
+        bool is_quit = false; // Флаг выхода из игры.
+        const int Max_turns = config("Game", "MaxNumTurns"); // Максимальное количество ходов из конфигурации.
 
-        //   ,          .
+        // Главный цикл игры, который выполняется до достижения максимального количества ходов или завершения игры.
         while (++turn_num < Max_turns)
         {
-            beat_series = 0; //    (beats).
+            beat_series = 0; // Сброс серии ударов (beats).
 
-            //       (    : 0  , 1  ).
-            logic.find_turns(turn_num % 2);
+            // Поиск возможных ходов для текущего игрока (цвет определяется по номеру хода: 0 — белые, 1 — черные).
+            logic.find_turns(turn_num % 2, Position(board.get_board()));
 
-            //    ,    ( ).
+            // Если нет доступных ходов, выходим из цикла (игра завершена).
             if (logic.turns.empty())
                 break;
 
-            //          .
+            // Установка глубины поиска для бота в зависимости от текущего игрока.
             logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
 
-            // ,       .
+            // Проверяем, является ли текущий игрок человеком или ботом.
             if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
             {
-                //   .   player_turn   .
+                // Игрок — человек. Вызываем функцию player_turn для выполнения хода.
                 auto resp = player_turn(turn_num % 2);
 
                 if (resp == Response::QUIT)
                 {
-                    //    ,   .
+                    // Если игрок выбрал выход, устанавливаем флаг выхода.
                     is_quit = true;
                     break;
                 }
                 else if (resp == Response::REPLAY)
                 {
-                    //     ,   replay.
+                    // Если игрок запросил повторную игру, устанавливаем флаг replay.
                     is_replay = true;
                     break;
                 }
                 else if (resp == Response::BACK)
                 {
-                    //     :
+                    // Если игрок запросил отмену хода:
                     if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
                         !beat_series && board.history_mtx.size() > 2)
                     {
-                        //  ,         .
+                        // Откатываем ход, если противник — бот и не было серии ударов.
                         board.rollback();
                         --turn_num;
                     }
                     if (!beat_series)
                         --turn_num;
-                    board.rollback(); //   .
+                    board.rollback(); // Откатываем последний ход.
                     --turn_num;
-                    beat_series = 0; //   .
+                    beat_series = 0; // Сбрасываем серию ударов.
                 }
             }
             else
             {
-                //   .   .
+                // Игрок — бот. Выполняем ход бота.
                 bot_turn(turn_num % 2);
             }
         }
 
-        //        .
+        // Запись времени окончания игры для расчета общей длительности.
         auto end = chrono::steady_clock::now();
 
-        //     -.
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        // Записываем время игры в лог-файл.
+        game_log().write(LogLevel::Info,
+            "Game time: " + to_string((int)chrono::duration<double, milli>(end - start).count()) + " millisec");
 
-        //     ,  play() .
+        // Дописываем партию в архив. Результат известен, только если партия доиграна до конца.
+        if (records.is_open() && board.record.plies)
+        {
+            board.record.result = GameResult::UNKNOWN;
+            if (!is_replay && !is_quit)
+            {
+                board.record.result = turn_num == Max_turns ? GameResult::DRAW :
+                    (turn_num % 2 ? GameResult::WHITE_WINS : GameResult::BLACK_WINS);
+            }
+            records.write(board.record);
+            records.flush(); // Партия не потеряется, даже если окно закроют аварийно
+        }
+
+        // Если была запрошена повторная игра, вызываем play() снова.
         if (is_replay)
             return play();
 
-        //      ,  .
+        // Если был выполнен выход из игры, завершаем функцию.
         if (is_quit)
             return 0;
 
-        //   :
-        int res = 2; //   .
+        // Определяем результат игры:
+        int res = 2; // По умолчанию ничья.
         if (turn_num == Max_turns)
         {
-            res = 0; //      .
+            res = 0; // Максимальное количество ходов достигнуто — ничья.
         }
         else if (turn_num % 2)
         {
-            res = 1; // ׸ .
+            res = 1; // Чёрные победили.
         }
         else
         {
-            res = -1; //  .
+            res = -1; // Белые победили.
         }
 
-        //     .
+        // Показываем результат игры на экране.
         board.show_final(res);
 
-        //      .
+        // Ждём реакцию игрока после окончания игры.
         auto resp = hand.wait();
         if (resp == Response::REPLAY)
         {
-            //     ,  play() .
+            // Если игрок запросил повторную игру, вызываем play() снова.
             is_replay = true;
             return play();
         }
 
-        return res; //   .
+        return res; // Возвращаем результат игры.
     }
 
 private:
     void bot_turn(const bool color)
     {
-        //     .
-        auto start = chrono::steady_clock::now(); //     .
-        auto delay_ms = config("Bot", "BotDelayMS"); //    .
+        // Функция для выполнения хода ботом.
+        auto start = chrono::steady_clock::now(); // Запись времени начала хода бота.
+        auto delay_ms = config("Bot", "BotDelayMS"); // Задержка перед ходом бота.
+
+        board.present(); // Показываем ход соперника до начала перебора.
 
-        //        .
+        // Создаем новый поток для задержки перед ходом бота.
         thread th(SDL_Delay, delay_ms);
-        auto turns = logic.find_best_turns(color); //     .
-        th.join(); //   .
+        auto turns = logic.find_best_turns(color, Position(board.get_board())); // Находим лучшие ходы для бота.
+        th.join(); // Дожидаемся завершения задержки.
 
-        bool is_first = true; //     .
+        bool is_first = true; // Флаг первого хода в серии.
         for (auto turn : turns)
         {
             if (!is_first)
             {
-                SDL_Delay(delay_ms); //    ,   .
+                SDL_Delay(delay_ms); // Добавляем задержку между ходами, если их несколько.
             }
             is_first = false;
 
-            //    ,    .
+            // Увеличиваем счетчик серий ударов, если ход включает удар.
             beat_series += (turn.xb != -1);
 
-            //    .
+            // Выполняем ход на доске и сразу показываем его (каждый удар серии - отдельным кадром).
             board.move_piece(turn, beat_series);
+            board.present();
         }
 
-        //      -.
+        // Записываем статистику хода бота одной строкой JSON в лог-файл: turn_ms - весь ход вместе с задержками
+        // и анимацией, остальные поля - find_best_turns (Game/SearchStats.h).
         auto end = chrono::steady_clock::now();
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        if (game_log().enabled(LogLevel::Info))
+        {
+            auto stats = logic.last_stats().to_json();
+            stats["turn_ms"] = (int)chrono::duration<double, milli>(end - start).count();
+            game_log().write(LogLevel::Info, stats.dump());
+        }
     }
 
     Response player_turn(const bool color)
     {
-        //     .
-        vector<pair<POS_T, POS_T>> cells; //     .
+        // Функция для выполнения хода игроком.
+        vector<pair<POS_T, POS_T>> cells; // Список возможных ячеек для выбора.
 
-        //      .
+        // Подсвечиваем все возможные ячейки для хода.
         for (auto turn : logic.turns)
         {
             cells.emplace_back(turn.x, turn.y);
         }
         board.highlight_cells(cells);
 
-        move_pos pos = { -1, -1, -1, -1 }; //   .
-        POS_T x = -1, y = -1; //   .
+        // Пока игрок думает, бот-соперник просчитывает ответы на его вероятные ходы.
+        if (config("Bot", "Ponder") && config("Bot", string("Is") + string((1 - color) ? "Black" : "White") + string("Bot")))
+        {
+            logic.start_ponder(1 - color, Position(board.get_board()),
+                config("Bot", string((1 - color) ? "Black" : "White") + string("BotLevel")));
+        }
+
+        move_pos pos = { -1, -1, -1, -1 }; // Инициализация позиции хода.
+        POS_T x = -1, y = -1; // Координаты выбранной фигуры.
 
-        //        .
+        // Цикл для выбора первой ячейки и выполнения хода.
         while (true)
         {
-            auto resp = hand.get_cell(); //   .
+            auto resp = hand.get_cell(); // Получаем выбор игрока.
             if (get<0>(resp) != Response::CELL)
             {
-                //    ,     (,   ),   .
+                // Если игрок выбрал действие, отличное от выбора клетки (например, выход или отмена), возвращаем соответствующий ответ.
+                logic.stop_ponder(); // Позиция изменится, просчитанные ответы не понадобятся.
                 return get<0>(resp);
             }
 
-            pair<POS_T, POS_T> cell{ get<1>(resp), get<2>(resp) }; //   .
+            pair<POS_T, POS_T> cell{ get<1>(resp), get<2>(resp) }; // Координаты выбранной клетки.
 
-            bool is_correct = false; //   .
+            bool is_correct = false; // Флаг корректности выбора.
 
-            // ,       .
+            // Проверяем, является ли выбранная клетка частью возможных ходов.
             for (auto turn : logic.turns)
             {
                 if (turn.x == cell.first && turn.y == cell.second)
@@ -225,12 +258,12 @@ private:
 
             if (pos.x != -1)
             {
-                break; //    ,  .
+                break; // Если ход выбран корректно, завершаем цикл.
             }
 
             if (!is_correct)
             {
-                //   ,      .
+                // Если клетка некорректна, очищаем подсветку и показываем доступные варианты.
                 if (x != -1)
                 {
                     board.clear_active();
@@ -247,7 +280,7 @@ private:
             board.clear_highlight();
             board.set_active(x, y);
 
-            //      .
+            // Подсвечиваем возможные ходы для выбранной фигуры.
             vector<pair<POS_T, POS_T>> cells2;
             for (auto turn : logic.turns)
             {
@@ -259,25 +292,28 @@ private:
             board.highlight_cells(cells2);
         }
 
-        //     .
+        // Ход выбран: останавливаем размышление бота, его ответ на этот ход мог уже быть найден.
+        logic.stop_ponder();
+
+        // Очищаем подсветку и выполняем ход.
         board.clear_highlight();
         board.clear_active();
         board.move_piece(pos, pos.xb != -1);
 
         if (pos.xb == -1)
         {
-            return Response::OK; //     ,  .
+            return Response::OK; // Если ход выполнен без удара, завершаем функцию.
         }
 
-        //   ,   .
+        // Продолжаем серию ударов, если это возможно.
         beat_series = 1;
         while (true)
         {
-            logic.find_turns(pos.x2, pos.y2); //     .
+            logic.find_turns(pos.x2, pos.y2, Position(board.get_board())); // Находим возможные ходы после удара.
 
             if (!logic.have_beats)
             {
-                break; //    ,  .
+                break; // Если больше нельзя ударить, завершаем цикл.
             }
 
             vector<pair<POS_T, POS_T>> cells;
@@ -288,7 +324,7 @@ private:
             board.highlight_cells(cells);
             board.set_active(pos.x2, pos.y2);
 
-            //   .
+            // Выбор следующего хода.
             while (true)
             {
                 auto resp = hand.get_cell();
@@ -312,7 +348,7 @@ private:
 
                 if (!is_correct)
                 {
-                    continue; //   ,  .
+                    continue; // Если выбор некорректен, продолжаем цикл.
                 }
 
                 board.clear_highlight();
@@ -323,14 +359,15 @@ private:
             }
         }
 
-        return Response::OK; //   .
+        return Response::OK; // Ход выполнен успешно.
     }
 
 private:
-    Config config; //      .
-    Board board; //   .
-    Hand hand; //     .
-    Logic logic; //    .
-    int beat_series; //   .
-    bool is_replay = false; //   .
+    Config config; // Объект для работы с конфигурацией игры.
+    Board board; // Объект игрового поля.
+    Hand hand; // Объект для управления действиями игрока.
+    Logic logic; // Объект для логики игры.
+    GameWriter records; // Архив сыгранных партий.
+    int beat_series; // Счетчик серий ударов.
+    bool is_replay = false; // Флаг повторной игры.
 };
\ No newline at end of file
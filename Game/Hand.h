@@ -4,120 +4,132 @@
 #include "../Models/Response.h"
 #include "Board.h"
 
-//  Hand      (,  )       .
+// Класс Hand отвечает за обработку действий пользователя (например, кликов мыши) и предоставляет интерфейс для взаимодействия с доской.
 class Hand
 {
 public:
-    //   Hand.     Board       .
+    // Конструктор класса Hand. Принимает указатель на объект Board для доступа к информации о игровом поле.
     Hand(Board* board) : board(board)
     {
     }
 
-    //  get_cell()          .
+    // Метод get_cell() обрабатывает события ввода пользователя и возвращает выбранную ячейку или действие.
     tuple<Response, POS_T, POS_T> get_cell() const
     {
-        SDL_Event windowEvent; //     SDL.
-        Response resp = Response::OK; //      .
-        int x = -1, y = -1; //   .
-        int xc = -1, yc = -1; //      .
+        SDL_Event windowEvent; // Переменная для хранения событий SDL.
+        Response resp = Response::OK; // Инициализация переменной для хранения типа ответа.
+        int x = -1, y = -1; // Координаты курсора мыши.
+        int xc = -1, yc = -1; // Преобразованные координаты клетки на игровом поле.
 
-        //     SDL.
+        // Цикл для обработки событий SDL.
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent)) //    SDL.
+            board->present(); // Показываем изменения доски, если они есть.
+            if (SDL_WaitEvent(&windowEvent)) // Ждем событие SDL (без опроса в холостом цикле).
             {
-                switch (windowEvent.type) //    .
+                switch (windowEvent.type) // Обработка различных типов событий.
                 {
-                case SDL_QUIT: //    .
-                    resp = Response::QUIT; //   QUIT.
+                case SDL_QUIT: // Если пользователь закрыл окно.
+                    resp = Response::QUIT; // Устанавливаем ответ QUIT.
                     break;
 
-                case SDL_MOUSEBUTTONDOWN: //     .
-                    x = windowEvent.motion.x; //    .
+                case SDL_MOUSEBUTTONDOWN: // Если пользователь нажал кнопку мыши.
+                    x = windowEvent.motion.x; // Получаем текущие координаты курсора.
                     y = windowEvent.motion.y;
-                    xc = int(y / (board->H / 10) - 1); //      .
+                    xc = int(y / (board->H / 10) - 1); // Преобразуем координаты курсора в индексы клеток.
                     yc = int(x / (board->W / 10) - 1);
 
-                    //   :
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1) //    .
+                    // Обработка специальных зон:
+                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1) // Проверка на отмену хода.
                     {
-                        resp = Response::BACK; //   BACK.
+                        resp = Response::BACK; // Устанавливаем ответ BACK.
                     }
-                    else if (xc == -1 && yc == 8) //    .
+                    else if (xc == -1 && yc == 8) // Проверка на повтор игры.
                     {
-                        resp = Response::REPLAY; //   REPLAY.
+                        resp = Response::REPLAY; // Устанавливаем ответ REPLAY.
                     }
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8) //       .
+                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8) // Проверка на выбор клетки внутри игрового поля.
                     {
-                        resp = Response::CELL; //   CELL.
+                        resp = Response::CELL; // Устанавливаем ответ CELL.
                     }
                     else
                     {
-                        xc = -1; //  ,      .
+                        xc = -1; // Сбрасываем координаты, если они находятся вне допустимой области.
                         yc = -1;
                     }
                     break;
 
-                case SDL_WINDOWEVENT: //     .
+                case SDL_WINDOWEVENT: // Обработка событий изменения размера окна.
                     if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
                     {
-                        board->reset_window_size(); //   .
+                        board->reset_window_size(); // Обновляем размеры окна.
                         break;
                     }
+                    break;
+
+                case SDL_RENDER_TARGETS_RESET: // Содержимое текстуры доски потеряно (например, при смене режима экрана).
+                    board->reset_window_size(); // Рисуем её заново.
+                    break;
                 }
 
-                if (resp != Response::OK) //     OK,   .
+                if (resp != Response::OK) // Если ответ отличен от OK, выходим из цикла.
                     break;
             }
         }
 
-        //     :     .
+        // Возвращаем результат в виде кортежа: тип ответа и координаты клетки.
         return { resp, xc, yc };
     }
 
-    //  wait()       (,   ).
+    // Метод wait() ожидает действия пользователя после завершения игры (например, повтор или выход).
     Response wait() const
     {
-        SDL_Event windowEvent; //     SDL.
-        Response resp = Response::OK; //      .
+        SDL_Event windowEvent; // Переменная для хранения событий SDL.
+        Response resp = Response::OK; // Инициализация переменной для хранения типа ответа.
 
-        //     SDL.
+        // Цикл для обработки событий SDL.
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent)) //    SDL.
+            board->present(); // Показываем изменения доски, если они есть.
+            if (SDL_WaitEvent(&windowEvent)) // Ждем событие SDL (без опроса в холостом цикле).
             {
-                switch (windowEvent.type) //    .
+                switch (windowEvent.type) // Обработка различных типов событий.
                 {
-                case SDL_QUIT: //    .
-                    resp = Response::QUIT; //   QUIT.
+                case SDL_QUIT: // Если пользователь закрыл окно.
+                    resp = Response::QUIT; // Устанавливаем ответ QUIT.
+                    break;
+
+                case SDL_WINDOWEVENT: // Обработка события изменения размера окна.
+                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                        board->reset_window_size(); // Обновляем размеры окна.
                     break;
 
-                case SDL_WINDOWEVENT_SIZE_CHANGED: //     .
-                    board->reset_window_size(); //   .
+                case SDL_RENDER_TARGETS_RESET: // Содержимое текстуры доски потеряно.
+                    board->reset_window_size(); // Рисуем её заново.
                     break;
 
-                case SDL_MOUSEBUTTONDOWN: //     .
+                case SDL_MOUSEBUTTONDOWN: // Если пользователь нажал кнопку мыши.
                 {
-                    int x = windowEvent.motion.x; //    .
+                    int x = windowEvent.motion.x; // Получаем текущие координаты курсора.
                     int y = windowEvent.motion.y;
-                    int xc = int(y / (board->H / 10) - 1); //      .
+                    int xc = int(y / (board->H / 10) - 1); // Преобразуем координаты курсора в индексы клеток.
                     int yc = int(x / (board->W / 10) - 1);
 
-                    if (xc == -1 && yc == 8) //     .
-                        resp = Response::REPLAY; //   REPLAY.
+                    if (xc == -1 && yc == 8) // Проверка на запрос повторной игры.
+                        resp = Response::REPLAY; // Устанавливаем ответ REPLAY.
                 }
                 break;
                 }
 
-                if (resp != Response::OK) //     OK,   .
+                if (resp != Response::OK) // Если ответ отличен от OK, выходим из цикла.
                     break;
             }
         }
 
-        //  .
+        // Возвращаем результат.
         return resp;
     }
 
 private:
-    Board* board; //    Board       .
+    Board* board; // Указатель на объект Board для доступа к информации о игровом поле.
 };
\ No newline at end of file
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <stdint.h>
+#include "../Models/Position.h"
+#include "../Models/Rays.h"
+#include "Cpu.h"
+
+// Пакетный разбор листьев последнего уровня перебора. После тихого хода на последнем уровне форсированный
+// перебор ударов (Logic::quiescence) генерирует все ходы листа только затем, чтобы узнать, есть ли удары
+// и есть ли ходы вообще; в большинстве листьев ударов нет, и лист сразу оценивается статически.
+// Для соседних листьев одного узла это считается сразу масками клеток: позиция листа - одна 32-битная
+// дорожка вектора (AVX2 - 8 листьев за инструкцию, SSE4.1 - 4), число ходов - подсчетом битов масок.
+const int LEAF_BATCH_SIZE = 8;
+
+// Листья пакета со стороны ходящего игрока (цвет ходящего один для всех листьев) и результат разбора
+struct LeafBatch {
+    alignas(32) uint32_t men[LEAF_BATCH_SIZE];   // Шашки ходящего
+    alignas(32) uint32_t kings[LEAF_BATCH_SIZE]; // Дамки ходящего
+    alignas(32) uint32_t opp[LEAF_BATCH_SIZE];   // Фигуры соперника
+    alignas(32) uint32_t beats[LEAF_BATCH_SIZE]; // Фигуры ходящего, которые могут бить (0 - ударов нет)
+    alignas(32) uint32_t moves[LEAF_BATCH_SIZE]; // Число тихих ходов ходящего
+};
+
+// Сдвиг маски клеток на одну клетку по направлению d (Rays.h): номер клетки (cell_to_sq) меняется на разное
+// число в четных и нечетных строках. Таблица абсолютных величин сдвига и масок клеток, у которых есть
+// соседняя клетка по направлению, для строк каждой четности; вычисляется на этапе компиляции
+struct LeafShifts {
+    int shift[4][2];
+    uint32_t mask[4][2];
+
+    constexpr LeafShifts() : shift{ { 4, 5 }, { 3, 4 }, { 4, 3 }, { 5, 4 } }, mask() {
+        for (int sq = 0; sq < 32; ++sq) {
+            for (int d = 0; d < 4; ++d) {
+                if (rays.step[sq][d] != OFF_BOARD)
+                    mask[d][sq_x(sq) % 2] |= uint32_t(1) << sq;
+            }
+        }
+    }
+
+    // Сдвиги совпадают с таблицей соседей rays.step
+    constexpr bool match_rays() const {
+        for (int sq = 0; sq < 32; ++sq) {
+            for (int d = 0; d < 4; ++d) {
+                const int step = shift[d][sq_x(sq) % 2];
+                if (rays.step[sq][d] != OFF_BOARD && rays.step[sq][d] != sq + (dir_forward(d) ? step : -step))
+                    return false;
+            }
+        }
+        return true;
+    }
+};
+
+constexpr LeafShifts leaf_shifts{};
+static_assert(leaf_shifts.match_rays(), "Leaf batch shifts");
+
+// Обратное направление
+constexpr int leaf_back(const int d) {
+    return 3 - d;
+}
+
+inline uint32_t leaf_step(const uint32_t mask, const int d) {
+    const uint32_t even = mask & leaf_shifts.mask[d][0], odd = mask & leaf_shifts.mask[d][1];
+    return dir_forward(d) ? (even << leaf_shifts.shift[d][0]) | (odd << leaf_shifts.shift[d][1]) :
+        (even >> leaf_shifts.shift[d][0]) | (odd >> leaf_shifts.shift[d][1]);
+}
+
+// Ядра разбора. Удар по направлению d: за фигурой соперника свободная клетка, а перед ней шашка ходящего
+// или дамка через любое число свободных клеток (длинная диагональ - не больше 6 клеток от дамки до фигуры).
+// Тихие ходы по направлению d: шашка - на соседнюю свободную клетку вперед (белые - к меньшим номерам клеток),
+// дамка - на каждую свободную клетку луча. Лучи разных фигур по одному направлению не пересекаются, поэтому
+// число ходов по направлению - число битов объединения клеток, куда можно пойти
+inline void leaf_scan_scalar(LeafBatch& batch, const bool black) {
+    for (int i = 0; i < LEAF_BATCH_SIZE; ++i) {
+        const uint32_t men = batch.men[i], kings = batch.kings[i], opp = batch.opp[i];
+        const uint32_t empty = ~(men | kings | opp);
+        uint32_t beats = 0, moves = 0;
+        for (int d = 0; d < 4; ++d) {
+            const int back = leaf_back(d);
+            uint32_t from = leaf_step(opp & leaf_step(empty, back), back); // Клетки перед битой фигурой
+            beats |= from & men;
+            for (int k = 0; kings && k < 6; ++k) {
+                beats |= from & kings;
+                from = leaf_step(from & empty, back);
+            }
+            uint32_t to = dir_forward(d) == black ? leaf_step(men, d) & empty : 0;
+            for (uint32_t ray = leaf_step(kings, d) & empty; ray; ray = leaf_step(ray, d) & empty) {
+                to |= ray;
+            }
+            moves += popcount(to);
+        }
+        batch.beats[i] = beats;
+        batch.moves[i] = moves;
+    }
+}
+
+#ifdef EVAL_X86
+template <int d> EVAL_TARGET("sse4.1") inline __m128i leaf_step_sse41(const __m128i mask) {
+    const __m128i even = _mm_and_si128(mask, _mm_set1_epi32(int(leaf_shifts.mask[d][0])));
+    const __m128i odd = _mm_and_si128(mask, _mm_set1_epi32(int(leaf_shifts.mask[d][1])));
+    const int shift_even = leaf_shifts.shift[d][0], shift_odd = leaf_shifts.shift[d][1];
+    return dir_forward(d) ?
+        _mm_or_si128(_mm_slli_epi32(even, shift_even), _mm_slli_epi32(odd, shift_odd)) :
+        _mm_or_si128(_mm_srli_epi32(even, shift_even), _mm_srli_epi32(odd, shift_odd));
+}
+
+// Число битов каждого байта (таблица по половинам байта)
+EVAL_TARGET("sse4.1") inline __m128i leaf_popcount8_sse41(const __m128i v) {
+    const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4), low = _mm_set1_epi8(0x0F);
+    return _mm_add_epi8(_mm_shuffle_epi8(lut, _mm_and_si128(v, low)),
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), low)));
+}
+
+// Удары и ходы по направлению d: ходы считаются по байтам в counts (не больше 4 * 8 в байте)
+template <int d> EVAL_TARGET("sse4.1") inline void leaf_dir_sse41(const __m128i men, const __m128i kings,
+    const __m128i opp, const __m128i empty, const bool black, const bool any_kings, __m128i& beats, __m128i& counts) {
+    constexpr int back = leaf_back(d);
+    __m128i from = leaf_step_sse41<back>(_mm_and_si128(opp, leaf_step_sse41<back>(empty)));
+    beats = _mm_or_si128(beats, _mm_and_si128(from, men));
+    __m128i to = dir_forward(d) == black ? _mm_and_si128(leaf_step_sse41<d>(men), empty) : _mm_setzero_si128();
+    if (any_kings) { // Лучи дамок (в пакете без дамок не считаются)
+        for (int k = 0; k < 6; ++k) {
+            beats = _mm_or_si128(beats, _mm_and_si128(from, kings));
+            from = leaf_step_sse41<back>(_mm_and_si128(from, empty));
+        }
+        __m128i ray = _mm_and_si128(leaf_step_sse41<d>(kings), empty);
+        for (int k = 0; k < 7; ++k) {
+            to = _mm_or_si128(to, ray);
+            ray = _mm_and_si128(leaf_step_sse41<d>(ray), empty);
+        }
+    }
+    counts = _mm_add_epi8(counts, leaf_popcount8_sse41(to));
+}
+
+EVAL_TARGET("sse4.1") inline void leaf_scan_sse41(LeafBatch& batch, const bool black) {
+    for (int i = 0; i < LEAF_BATCH_SIZE; i += 4) {
+        const __m128i men = _mm_load_si128(reinterpret_cast<const __m128i*>(batch.men + i));
+        const __m128i kings = _mm_load_si128(reinterpret_cast<const __m128i*>(batch.kings + i));
+        const __m128i opp = _mm_load_si128(reinterpret_cast<const __m128i*>(batch.opp + i));
+        const __m128i empty = _mm_xor_si128(_mm_or_si128(_mm_or_si128(men, kings), opp), _mm_set1_epi32(-1));
+        const bool any_kings = !_mm_testz_si128(kings, kings);
+        __m128i beats = _mm_setzero_si128(), counts = _mm_setzero_si128();
+        leaf_dir_sse41<0>(men, kings, opp, empty, black, any_kings, beats, counts);
+        leaf_dir_sse41<1>(men, kings, opp, empty, black, any_kings, beats, counts);
+        leaf_dir_sse41<2>(men, kings, opp, empty, black, any_kings, beats, counts);
+        leaf_dir_sse41<3>(men, kings, opp, empty, black, any_kings, beats, counts);
+        // Сумма четырех байтов дорожки: попарно в int16, затем в int32
+        const __m128i moves = _mm_madd_epi16(_mm_maddubs_epi16(counts, _mm_set1_epi8(1)), _mm_set1_epi16(1));
+        _mm_store_si128(reinterpret_cast<__m128i*>(batch.beats + i), beats);
+        _mm_store_si128(reinterpret_cast<__m128i*>(batch.moves + i), moves);
+    }
+}
+
+template <int d> EVAL_TARGET("avx2") inline __m256i leaf_step_avx2(const __m256i mask) {
+    const __m256i even = _mm256_and_si256(mask, _mm256_set1_epi32(int(leaf_shifts.mask[d][0])));
+    const __m256i odd = _mm256_and_si256(mask, _mm256_set1_epi32(int(leaf_shifts.mask[d][1])));
+    const int shift_even = leaf_shifts.shift[d][0], shift_odd = leaf_shifts.shift[d][1];
+    return dir_forward(d) ?
+        _mm256_or_si256(_mm256_slli_epi32(even, shift_even), _mm256_slli_epi32(odd, shift_odd)) :
+        _mm256_or_si256(_mm256_srli_epi32(even, shift_even), _mm256_srli_epi32(odd, shift_odd));
+}
+
+EVAL_TARGET("avx2") inline __m256i leaf_popcount8_avx2(const __m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+        _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+}
+
+template <int d> EVAL_TARGET("avx2") inline void leaf_dir_avx2(const __m256i men, const __m256i kings,
+    const __m256i opp, const __m256i empty, const bool black, const bool any_kings, __m256i& beats, __m256i& counts) {
+    constexpr int back = leaf_back(d);
+    __m256i from = leaf_step_avx2<back>(_mm256_and_si256(opp, leaf_step_avx2<back>(empty)));
+    beats = _mm256_or_si256(beats, _mm256_and_si256(from, men));
+    __m256i to = dir_forward(d) == black ? _mm256_and_si256(leaf_step_avx2<d>(men), empty) : _mm256_setzero_si256();
+    if (any_kings) { // Лучи дамок (в пакете без дамок не считаются)
+        for (int k = 0; k < 6; ++k) {
+            beats = _mm256_or_si256(beats, _mm256_and_si256(from, kings));
+            from = leaf_step_avx2<back>(_mm256_and_si256(from, empty));
+        }
+        __m256i ray = _mm256_and_si256(leaf_step_avx2<d>(kings), empty);
+        for (int k = 0; k < 7; ++k) {
+            to = _mm256_or_si256(to, ray);
+            ray = _mm256_and_si256(leaf_step_avx2<d>(ray), empty);
+        }
+    }
+    counts = _mm256_add_epi8(counts, leaf_popcount8_avx2(to));
+}
+
+EVAL_TARGET("avx2") inline void leaf_scan_avx2(LeafBatch& batch, const bool black) {
+    static_assert(LEAF_BATCH_SIZE == 8, "Leaf batch is one AVX2 register");
+    const __m256i men = _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.men));
+    const __m256i kings = _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.kings));
+    const __m256i opp = _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.opp));
+    const __m256i empty = _mm256_xor_si256(_mm256_or_si256(_mm256_or_si256(men, kings), opp), _mm256_set1_epi32(-1));
+    const bool any_kings = !_mm256_testz_si256(kings, kings);
+    __m256i beats = _mm256_setzero_si256(), counts = _mm256_setzero_si256();
+    leaf_dir_avx2<0>(men, kings, opp, empty, black, any_kings, beats, counts);
+    leaf_dir_avx2<1>(men, kings, opp, empty, black, any_kings, beats, counts);
+    leaf_dir_avx2<2>(men, kings, opp, empty, black, any_kings, beats, counts);
+    leaf_dir_avx2<3>(men, kings, opp, empty, black, any_kings, beats, counts);
+    const __m256i moves = _mm256_madd_epi16(_mm256_maddubs_epi16(counts, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(batch.beats), beats);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(batch.moves), moves);
+}
+#endif
+
+// Разбор всех LEAF_BATCH_SIZE листьев пакета (black - цвет ходящего) набором инструкций kernel.
+// Все ядра дают одинаковый результат
+inline void leaf_scan(LeafBatch& batch, const bool black, const EvalKernel kernel) {
+    switch (kernel) {
+#ifdef EVAL_X86
+    case EvalKernel::AVX2:
+        leaf_scan_avx2(batch, black);
+        break;
+    case EvalKernel::SSE41:
+        leaf_scan_sse41(batch, black);
+        break;
+#endif
+    default:
+        leaf_scan_scalar(batch, black);
+    }
+}
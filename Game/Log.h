@@ -0,0 +1,392 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Журнал игры (log.txt). Строки кладутся из любого потока в кольцевой буфер без блокировок и без выделения памяти,
+// а в файл их пишет отдельный поток пачками, поэтому поток игры и потоки перебора не ждут диска.
+// Строка в файле: "<секунды от открытия журнала> <уровень> <текст>".
+
+// Уровни сообщений (строки записываются, если их уровень не ниже уровня журнала)
+enum class LogLevel { Debug, Info, Warning, Error };
+
+inline const char* log_level_name(const LogLevel level) {
+    static const char* names[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+    return names[int(level)];
+}
+
+// Уровень по названию из настроек ("Debug", "Info", "Warning", "Error"), по умолчанию - Info
+inline LogLevel parse_log_level(const std::string& name) {
+    for (int i = 0; i <= int(LogLevel::Error); ++i) {
+        const char* full = log_level_name(LogLevel(i));
+        if (name.size() == strlen(full) && std::equal(name.begin(), name.end(), full,
+            [](const char a, const char b) { return toupper((unsigned char)a) == b; }))
+            return LogLevel(i);
+    }
+    return LogLevel::Info;
+}
+
+// Емкость ячейки кольцевого буфера: длинная строка занимает несколько ячеек подряд
+const size_t LOG_SLOT_TEXT = 240;
+// Количество ячеек (степень двойки). Если писатель не успевает и буфер заполнен, строки отбрасываются
+// и в журнал записывается их количество: поток игры никогда не ждет журнал
+const size_t LOG_SLOTS = 4096;
+
+// Класс Logger - асинхронный журнал. Кольцевой буфер - очередь многих писателей и одного читателя
+// с номером у каждой ячейки (ячейка свободна для позиции pos, если ее номер равен pos, и заполнена, если pos + 1).
+// Строка из n ячеек занимает их одной операцией compare_exchange над позицией записи, поэтому части строк
+// разных потоков не перемешиваются. Поток записи забирает все заполненные ячейки, пишет их через буфер stdio
+// и сбрасывает файл, когда буфер пуст. При превышении размера файл переименовывается в log.txt.1 (старые
+// сдвигаются до log.txt.<files>), и начинается новый. При выходе (деструктор) и std::terminate оставшиеся
+// строки дописываются в файл обычным путем, при сигналах аварийного завершения - напрямую через write (см. on_signal).
+class Logger {
+public:
+    Logger() {
+        for (size_t i = 0; i < LOG_SLOTS; ++i) {
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~Logger() {
+        close();
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Открытие журнала path (файл очищается): уровень, размер файла до ротации в байтах (0 - без ротации),
+    // количество хранимых старых файлов
+    bool open(const std::string& file_path, const LogLevel min_level, const size_t max_file_size,
+        const int max_files) {
+        close();
+        file = std::fopen(file_path.c_str(), "w");
+        if (!file)
+            return false;
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+        fd.store(file_handle(file), std::memory_order_relaxed);
+        path = file_path;
+        level.store(int(min_level), std::memory_order_relaxed);
+        max_size = max_file_size;
+        files = max_files;
+        file_size = 0;
+        dropped.store(0, std::memory_order_relaxed);
+        start = std::chrono::steady_clock::now();
+        stop = false;
+        writer = std::thread(&Logger::run, this);
+        install_crash_handlers(this);
+        opened.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool is_open() const {
+        return opened.load(std::memory_order_acquire);
+    }
+
+    // Запишется ли строка уровня level (чтобы не собирать текст напрасно)
+    bool enabled(const LogLevel message_level) const {
+        return is_open() && int(message_level) >= level.load(std::memory_order_relaxed);
+    }
+
+    // Строка text в журнал. Только копирование в буфер: не ждет диска и не выделяет память
+    void write(const LogLevel message_level, const std::string& text) {
+        if (!enabled(message_level))
+            return;
+        char prefix[48];
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const int prefix_size = snprintf(prefix, sizeof(prefix), "%.3f %s ", seconds, log_level_name(message_level));
+        const size_t size = std::min(prefix_size + text.size(), LOG_SLOT_TEXT * (LOG_SLOTS / 4));
+        const size_t n = (size + LOG_SLOT_TEXT - 1) / LOG_SLOT_TEXT;
+
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (int attempt = 0;;) {
+            bool stale = false, full = false; // Позицию уже занял другой поток; ячейка еще не прочитана
+            for (size_t i = 0; i < n && !stale && !full; ++i) {
+                const size_t seq = slots[(pos + i) % LOG_SLOTS].seq.load(std::memory_order_acquire);
+                if (seq != pos + i) {
+                    full = ptrdiff_t(seq - (pos + i)) < 0;
+                    stale = !full;
+                }
+            }
+            if (full) {
+                // Строку ошибки ждем до 100 мс (она может быть последней перед аварией), остальные отбрасываем
+                wake.notify_one();
+                if (message_level != LogLevel::Error || ++attempt > 1000) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            if (stale || full) {
+                pos = head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (head.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                break;
+        }
+
+        size_t copied = 0;
+        for (size_t i = 0; i < n; ++i) {
+            Slot& slot = slots[(pos + i) % LOG_SLOTS];
+            const size_t length = std::min(LOG_SLOT_TEXT, size - copied);
+            for (size_t j = 0; j < length; ++j, ++copied) {
+                slot.text[j] = copied < size_t(prefix_size) ? prefix[copied] : text[copied - prefix_size];
+            }
+            slot.length = uint16_t(length);
+            slot.more = i + 1 < n;
+            slot.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        // Поток записи будим сразу для ошибки (она может предшествовать аварии) и каждую четверть буфера,
+        // иначе он проснется сам не позже чем через 50 мс
+        if (message_level == LogLevel::Error || (pos + n) / (LOG_SLOTS / 4) != pos / (LOG_SLOTS / 4))
+            wake.notify_one();
+    }
+
+    // Ожидание записи в файл всех строк, добавленных до вызова
+    void flush() {
+        if (!is_open())
+            return;
+        const size_t target = head.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> guard(lock);
+        flush_target = std::max(flush_target, target);
+        wake.notify_one();
+        written.wait(guard, [&]() { return flushed >= target || stop; });
+    }
+
+    // Запись оставшихся строк и остановка потока записи
+    void close() {
+        if (!opened.exchange(false))
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        wake.notify_one();
+        writer.join();
+        install_crash_handlers(nullptr);
+        fd.store(-1, std::memory_order_relaxed);
+        std::fclose(file);
+        file = nullptr;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{ 0 };
+        uint16_t length = 0;
+        bool more = false; // Строка продолжается в следующей ячейке
+        char text[LOG_SLOT_TEXT];
+    };
+
+    // Поток записи: забирает строки, пока они есть, и засыпает до следующей строки ошибки, flush или 50 мс
+    void run() {
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            const bool stopping = stop;
+            guard.unlock();
+            drain();
+            guard.lock();
+            flushed = tail_written;
+            written.notify_all();
+            if (stopping)
+                break;
+            if (flush_target <= flushed)
+                wake.wait_for(guard, std::chrono::milliseconds(50));
+        }
+    }
+
+    // Запись всех заполненных ячеек в файл. Вызывается потоком записи или обработчиком аварийного завершения
+    // (только один из них, см. draining)
+    void drain() {
+        bool expected = false;
+        if (!draining.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return;
+        bool any = false;
+        for (;;) {
+            Slot& slot = slots[tail % LOG_SLOTS];
+            if (slot.seq.load(std::memory_order_acquire) != tail + 1)
+                break;
+            if (line_start) {
+                if (const size_t n = dropped.exchange(0, std::memory_order_relaxed)) {
+                    char text[64];
+                    put(text, size_t(snprintf(text, sizeof(text), "%zu log lines dropped (buffer full)\n", n)));
+                }
+                if (max_size && file_size >= max_size)
+                    rotate();
+            }
+            put(slot.text, slot.length);
+            if (!slot.more)
+                put("\n", 1);
+            line_start = !slot.more;
+            slot.seq.store(tail + LOG_SLOTS, std::memory_order_release);
+            ++tail;
+            any = true;
+        }
+        if (any && file)
+            std::fflush(file);
+        if (line_start) // Незаконченная строка еще пишется другим потоком
+            tail_written = tail;
+        draining.store(false, std::memory_order_release);
+    }
+
+    void put(const char* text, const size_t size) {
+        if (file)
+            std::fwrite(text, 1, size, file);
+        file_size += size;
+    }
+
+    // Ротация: log.txt -> log.txt.1 -> ... -> log.txt.<files>, самый старый удаляется
+    void rotate() {
+        std::fclose(file);
+        if (files > 0) {
+            std::remove((path + "." + std::to_string(files)).c_str());
+            for (int i = files - 1; i >= 1; --i) {
+                std::rename((path + "." + std::to_string(i)).c_str(), (path + "." + std::to_string(i + 1)).c_str());
+            }
+            std::rename(path.c_str(), (path + ".1").c_str());
+        }
+        file = std::fopen(path.c_str(), "w");
+        if (file)
+            std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+        fd.store(file ? file_handle(file) : -1, std::memory_order_relaxed);
+        file_size = 0;
+    }
+
+    // Дескриптор открытого файла (для записи в обработчике сигнала)
+    static int file_handle(std::FILE* f) {
+#ifdef _WIN32
+        return _fileno(f);
+#else
+        return fileno(f);
+#endif
+    }
+
+    // Запись в дескриптор без stdio (допустима в обработчике сигнала)
+    static void raw_write(const int handle, const char* text, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            const int n = _write(handle, text, unsigned(size));
+#else
+            const ssize_t n = ::write(handle, text, size);
+#endif
+            if (n <= 0)
+                return;
+            text += n;
+            size -= size_t(n);
+        }
+    }
+
+    // Дописывание журнала при аварийном завершении: строки из буфера пишутся в потоке, в котором случилась
+    // авария, затем аварийное завершение продолжается как обычно
+    static Logger*& crash_logger() {
+        static Logger* logger = nullptr;
+        return logger;
+    }
+
+    // Для std::terminate (обычный контекст потока, stdio и ожидание допустимы; в обработчике сигнала - signal_flush)
+    static void crash_flush() {
+        Logger* logger = crash_logger();
+        if (!logger)
+            return;
+        // Если авария случилась во время записи, ждем ее окончания недолго: авария могла быть и в потоке записи
+        for (int i = 0; i < 1000 && logger->draining.load(std::memory_order_acquire); ++i)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        logger->drain();
+        if (logger->file)
+            std::fflush(logger->file);
+    }
+
+    // Обработчик сигнала может вызывать только безопасные в нем функции: без stdio, блокировок, ожидания и выделения
+    // памяти. Заполненные ячейки пишутся write в дескриптор файла, открытого заранее. Буфер stdio пуст, пока
+    // ячейки никто не читает (drain сбрасывает его перед тем, как отпустить draining), а если сигнал пришел во
+    // время drain, строки не дописываются: ждать в обработчике нельзя, и часть строк уже в буфере stdio.
+    // draining не отпускается, чтобы поток записи не начал писать в файл одновременно. Строки о переполнении
+    // буфера и ротация здесь пропускаются. Затем сигнал повторяется с обработкой по умолчанию
+    static void signal_flush() {
+        Logger* logger = crash_logger();
+        if (!logger)
+            return;
+        bool expected = false;
+        if (!logger->draining.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return;
+        const int handle = logger->fd.load(std::memory_order_relaxed);
+        while (handle >= 0) {
+            Slot& slot = logger->slots[logger->tail % LOG_SLOTS];
+            if (slot.seq.load(std::memory_order_acquire) != logger->tail + 1)
+                break;
+            raw_write(handle, slot.text, slot.length);
+            if (!slot.more)
+                raw_write(handle, "\n", 1);
+            ++logger->tail;
+        }
+    }
+
+    static void on_signal(const int sig) {
+        signal_flush();
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
+
+    static void install_crash_handlers(Logger* logger) {
+        crash_logger() = logger;
+        static bool installed = false;
+        if (!logger || installed)
+            return;
+        installed = true;
+        for (const int sig : { SIGSEGV, SIGABRT, SIGFPE, SIGILL }) {
+            std::signal(sig, on_signal);
+        }
+        static std::terminate_handler previous = std::set_terminate([]() {
+            crash_flush();
+            if (previous)
+                previous();
+            std::abort();
+        });
+    }
+
+    Slot slots[LOG_SLOTS];
+    alignas(64) std::atomic<size_t> head{ 0 }; // Позиция записи (следующая свободная ячейка)
+    alignas(64) size_t tail = 0;               // Позиция чтения (только поток записи)
+    std::atomic<size_t> dropped{ 0 };          // Строки, не поместившиеся в буфер
+    std::atomic<bool> draining{ false };       // Ячейки читаются (потоком записи или при аварии)
+    bool line_start = true;                    // Следующая ячейка - начало строки
+
+    std::atomic<bool> opened{ false };
+    std::atomic<int> level{ int(LogLevel::Info) };
+    std::FILE* file = nullptr;
+    std::atomic<int> fd{ -1 };                 // Дескриптор file (для on_signal)
+    std::string path;
+    size_t max_size = 0, file_size = 0;
+    int files = 0;
+    std::chrono::steady_clock::time_point start;
+
+    std::thread writer;
+    std::mutex lock;
+    std::condition_variable wake;              // Пробуждение потока записи
+    std::condition_variable written;           // Строки до flushed записаны
+    bool stop = false;
+    size_t flush_target = 0, flushed = 0, tail_written = 0;
+};
+
+// Журнал игры (один на процесс)
+inline Logger& game_log() {
+    static Logger logger;
+    return logger;
+}
@@ -1,267 +1,1397 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/Position.h"
+#include "../Models/Project_path.h"
+#include "../Models/Rays.h"
+#include "Book.h"
 #include "Config.h"
+#include "Endgame.h"
+#include "Evaluation.h"
+#include "LeafBatch.h"
+#include "MoveList.h"
+#include "SearchStats.h"
+#include "Transposition.h"
+#include "WorkStealing.h"
+
+// Logic не зависит от Board и SDL: позиция передается в функции поиска,
+// поэтому перебор можно использовать и без окна (инструменты, матчи ботов)
+using namespace std;
+
+// Максимальная глубина, для которой хранятся ходы-убийцы
+const int MAX_PLY = 64;
+// Начальная емкость цепочек лучших ударов из корня в состоянии потока
+const size_t CHAIN_ARENA_SIZE = 1024;
+// Окно стремления в корне: оценка прошлого поиска той же позиции, деленная и умноженная на этот множитель
+// (оценка - отношение материала, поэтому окно тоже относительное; 1% - пара шагов продвижения шашек)
+const double ASPIRATION_WINDOW = 1.01;
+// Оценки из таблиц окончаний: победа - INF минус полуходов до конца игры, поражение - (полуходов + 1) *
+// ENDGAME_LOSS_STEP. Полуходов меньше ENDGAME_SCORE_PLIES, поэтому эти полосы не пересекаются с оценками
+// материала и сети (оценка сети - от exp(-NN_MAX_LOG) ~ 2e-9 до exp(NN_MAX_LOG) ~ 5e8)
+const double ENDGAME_LOSS_STEP = 1e-12;
+const int ENDGAME_SCORE_PLIES = 1024;
+
+struct RootSearch;
+struct SplitPoint;
+
+// Состояние одного потока перебора: упорядочивание, позиция перебора и цепочка лучших ударов.
+// У каждого потока свое состояние, общие у потоков только таблица транспозиций, данные корня и точки разделения.
+// Перебор не выделяет память в куче: списки ходов - MoveList в стеке, цепочки ударов - арена потока
+// (память под них выделяется при создании Logic и только переиспользуется)
+struct SearchState {
+    default_random_engine rand_eng;  // Генератор случайных чисел для перемешивания ходов
+    int killers[MAX_PLY][2];         // Ходы-убийцы по глубине (from * 32 + to, -1 - нет хода)
+    int history[32][32] = {};        // История отсечений тихими ходами по клеткам начала и конца
+    vector<move_pos> next_move;      // Арена: последовательность следующих ходов в серии ударов
+    vector<int> next_best_state;     // Арена: последовательность следующих состояний в серии ударов
+    size_t nodes = 0;                // Счетчик просмотренных узлов (вместе с узлами форсированного перебора)
+    size_t qnodes = 0;               // Узлы форсированного перебора ударов (на предельной глубине и за ней)
+    size_t stand_pats = 0;           // Спокойные позиции форсированного перебора, оцененные статически
+    SearchCounters counters;         // Статистика перебора потока за текущий ход (SEARCH_STATS)
+    int series = 0;                  // Шагов в последней серии ударов позиции перебора (SEARCH_STATS)
+    int series_sq = -1;              // Клетка, на которую пришел последний ход, если он - удар (SEARCH_STATS)
+    Position pos;                    // Позиция перебора: ходы делаются и отменяются на месте (make/unmake)
+    EvalTerms ev;                    // Слагаемые оценки позиции перебора
+    bool stop = false;               // Поток прервал перебор по времени
+    RootSearch* root = nullptr;      // Общие данные перебора из корня
+    SplitPoint* split = nullptr;     // Ближайшая точка разделения, внутри которой работает поток
+    unique_ptr<WorkQueue> queue = make_unique<WorkQueue>(); // Задачи, которые могут украсть другие потоки
+};
+
+// Отмена хода в позиции перебора потока: сведения для доски и прежние слагаемые оценки
+struct MoveUndo {
+    UndoRecord board;
+    EvalTerms ev;
+#if SEARCH_STATS
+    int series, series_sq;
+#endif
+};
+
+// Общие данные потоков при переборе ходов из корня
+struct RootSearch {
+    Position pos;                    // Позиция корня
+    EvalTerms ev;                    // Слагаемые оценки позиции корня
+    MoveList turns;                  // Ходы из корня в порядке просмотра
+    bool have_beats = false;         // Являются ли ходы из корня ударами
+    atomic<int> next{ 0 };           // Индекс следующего непросмотренного хода
+    atomic<int> done{ 0 };           // Количество просмотренных ходов
+    atomic<bool> open{ false };      // Первый ход просмотрен, остальные можно брать всем потокам
+    atomic<bool> stop{ false };      // Один из потоков прервал перебор по времени
+    atomic<double> alpha{ -1 };      // Граница alpha: чуть меньше лучшей найденной оценки
+    double beta = INF + 1;           // Граница beta (верх окна стремления)
+    mutex lock;                      // Защита лучшего результата
+    double best_score = -1;          // Лучшая оценка
+    int best_index = -1;             // Индекс лучшего хода
+    MoveList best_line;              // Лучший ход вместе с продолжением серии ударов
+};
+
+// Оценки узла во время перебора его ходов
+struct NodeScores {
+    double alpha, beta;              // Текущее окно
+    double alpha_orig;               // Нижняя граница окна для определения типа оценки в таблице
+    double min_score = INF + 1;      // Минимальная оценка
+    double max_score = -1;           // Максимальная оценка
+    move_pos best_turn = move_pos(-1, -1, -1, -1); // Лучший ход в узле для таблицы транспозиций
+};
+
+// Точка разделения (Young Brothers Wait): узел, первый ход которого владелец просмотрел сам,
+// а остальные ходы выложил задачами в свою очередь. Живет в стеке владельца, пока все задачи не завершены.
+struct SplitPoint {
+    SplitPoint* parent = nullptr;    // Точка разделения, внутри которой находится узел
+    Position pos;                    // Позиция узла
+    EvalTerms ev;                    // Слагаемые оценки позиции узла
+    bool color = false;              // Очередь хода в узле
+    size_t depth = 0;                // Глубина узла
+    bool have_beats = false;         // Являются ли ходы узла ударами
+    const MoveList* turns = nullptr; // Ходы узла
+    mutex lock;                      // Защита оценок узла
+    NodeScores node;                 // Оценки узла
+    bool cutoff = false;             // Произошло отсечение
+    atomic<int> pending{ 0 };        // Количество незавершенных задач
+    atomic<bool> cancel{ false };    // Отсечение: оставшиеся и уже взятые ходы смотреть не нужно
+};
+
+// Размышление в ходе соперника: фоновый поток и найденные им ответы бота
+struct Ponder {
+    thread th;                       // Поток размышления
+    atomic<bool> cancel{ false };    // Запрос на остановку (ход соперника сделан или отменен)
+    bool color = false;              // Цвет бота, за который считались ответы
+    int depth = -1;                  // Глубина, на которую посчитаны ответы
+    vector<pair<Position, MoveList>> results; // Позиции после ходов соперника и лучшие ответы на них
+
+    ~Ponder() {
+        cancel = true;
+        if (th.joinable())
+            th.join();
+    }
+};
 
-//      
-const int INF = 1e9;
 class Logic {
 public:
-    //  
-    Logic(Board* board, Config* config) : board(board), config(config) {
-        rand_eng = std::default_random_engine(
-            !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
-        scoring_mode = (*config)("Bot", "BotScoringType");
+    // Конструктор класса
+    Logic(Config* config) : config(config) {
+        no_random = (*config)("Bot", "NoRandom");
+        const unsigned seed_setting = (*config)("Bot", "Seed");
+        seed = no_random ? 0 : (seed_setting ? seed_setting : unsigned(time(0)));
+        evaluator = Evaluator((*config)("Bot", "BotScoringType").get<string>(),
+            project_path + (*config)("Bot", "NetworkFile").get<string>());
+        const string weights_file = (*config)("Bot", "WeightsFile");
+        EvalWeights weights; // Подобранные веса необязательны и меняют только "NumberAndPotential"
+        if ((*config)("Bot", "BotScoringType").get<string>() == "NumberAndPotential" && !weights_file.empty() &&
+            weights.load(project_path + weights_file)) {
+            evaluator.set_weights(weights);
+        }
         optimization = (*config)("Bot", "Optimization");
+        quiescence_enabled = (*config)("Bot", "Quiescence");
+        const size_t tt_size_mb = (*config)("Bot", "TTSizeMB");
+        tt = TranspositionTable(optimization != "O0" ? tt_size_mb : 0); // Таблица транспозиций (не используется в O0)
+        time_limit_ms = (*config)("Bot", "BotTimeMS");
+        int threads = (*config)("Bot", "Threads"); // Число потоков перебора (0 - по числу ядер)
+        if (threads <= 0) {
+            threads = max(1, int(thread::hardware_concurrency()));
+        }
+        split_depth = (*config)("Bot", "SplitDepth");
+        const string endgame_file = (*config)("Bot", "EndgameFile");
+        if (optimization != "O0" && !endgame_file.empty()) { // Таблицы окончаний необязательны
+            endgame.open(project_path + endgame_file);
+        }
+        const string book_file = (*config)("Bot", "BookFile");
+        if (!book_file.empty()) { // Дебютная книга необязательна
+            book.open(project_path + book_file);
+        }
+        ponder = make_unique<Ponder>();
+        states.resize(threads);
+        for (size_t i = 0; i < states.size(); ++i) {
+            states[i].rand_eng = default_random_engine(unsigned(seed + i));
+            states[i].next_move.reserve(CHAIN_ARENA_SIZE);
+            states[i].next_best_state.reserve(CHAIN_ARENA_SIZE);
+        }
+        clear_ordering();
+    }
+
+    // Основная функция для поиска лучших ходов в позиции pos.
+    // Если задан BotTimeMS, глубина увеличивается на 1 до Max_depth, пока не закончится время на ход,
+    // и возвращается лучшая последовательность последней полностью просчитанной глубины.
+    // Поиск с одним потоком не выделяет память в куче (с несколькими - только при запуске потоков)
+    MoveList find_best_turns(const bool color, const Position& pos) {
+        stop_ponder();
+        const auto start = chrono::steady_clock::now();
+        start_stats(color);
+        MoveList res = choose_turns(color, pos);
+        finish_stats(start);
+        return res;
+    }
+
+    // Статистика последнего хода find_best_turns (строка журнала - last_stats().to_json().dump())
+    const MoveStats& last_stats() const {
+        return move_stats;
+    }
+
+    // Ход из дебютной книги для позиции pos (пустая последовательность, если позиции нет в книге).
+    // В детерминированном режиме выбирается ход с наибольшим весом, иначе - случайный пропорционально весу
+    MoveList find_book_turns(const bool color, const Position& pos) {
+        size_t first = 0;
+        const size_t n = book.enabled() ? book.find(zobrist_hash(pos, color, false), first) : 0;
+        if (!n)
+            return {};
+        size_t choice = 0;
+        if (!no_random) {
+            uint64_t total = 0;
+            for (size_t i = 0; i < n; ++i) {
+                total += book.entry(first + i).weight;
+            }
+            uint64_t r = uniform_int_distribution<uint64_t>(0, max<uint64_t>(total, 1) - 1)(states[0].rand_eng);
+            while (choice + 1 < n && r >= book.entry(first + choice).weight) {
+                r -= book.entry(first + choice).weight;
+                ++choice;
+            }
+        }
+
+        // Восстанавливаем ходы по клеткам записи, проверяя, что они возможны в позиции
+        const BookEntry entry = book.entry(first + choice);
+        MoveList line, list;
+        Position cur = pos;
+        for (int i = 1; i < entry.length; ++i) {
+            if (i == 1) {
+                find_turns(states[0], color, cur, list);
+            }
+            else if (!find_turns(line.back().x2, line.back().y2, cur, list)) {
+                return {};
+            }
+            const auto it = find_if(list.begin(), list.end(), [&](const move_pos& turn) {
+                return cell_to_sq(turn.x, turn.y) == entry.path[i - 1] && cell_to_sq(turn.x2, turn.y2) == entry.path[i];
+            });
+            if (it == list.end())
+                return {};
+            line.push_back(*it);
+            cur = cur.make_turn(*it);
+        }
+        // Серия ударов должна быть закончена
+        if (!line.empty() && line.back().xb != -1 && find_turns(line.back().x2, line.back().y2, cur, list))
+            return {};
+        return line;
+    }
+
+    // Подготовка к новой партии: таблица транспозиций очищается, генераторы случайных чисел
+    // получают начальное значение new_seed (в детерминированном режиме оно не меняется)
+    void new_game(const unsigned new_seed) {
+        stop_ponder();
+        tt.clear();
+        if (!no_random) {
+            seed = new_seed;
+        }
+        for (size_t i = 0; i < states.size(); ++i) {
+            states[i].rand_eng = default_random_engine(unsigned(seed + i));
+        }
+        for (auto& st : states) { // История отсечений прошлой партии не нужна
+            for (auto& row : st.history)
+                for (auto& value : row)
+                    value = 0;
+        }
+        clear_ordering();
+        last_root_key = 0;
+    }
+
+    // Оценка корня последнего завершенного поиска со стороны ходившего бота (отношение материала, INF - победа)
+    double root_score() const {
+        return last_root_score;
     }
 
-    //      
-    vector<move_pos> find_best_turns(const bool color) {
-        next_best_state.clear(); //    
-        next_move.clear();       //    
+    // Количество узлов, просмотренных всеми потоками с момента создания
+    size_t nodes() const {
+        size_t res = 0;
+        for (const auto& st : states) {
+            res += st.nodes;
+        }
+        return res;
+    }
+
+    // Количество узлов форсированного перебора ударов на предельной глубине и за ней (входят в nodes)
+    size_t qnodes() const {
+        size_t res = 0;
+        for (const auto& st : states) {
+            res += st.qnodes;
+        }
+        return res;
+    }
 
-        //     
-        find_first_best_turn(board->get_board(), color, -1, -1, 0);
+    // Количество спокойных позиций форсированного перебора, оцененных статически
+    size_t stand_pats() const {
+        size_t res = 0;
+        for (const auto& st : states) {
+            res += st.stand_pats;
+        }
+        return res;
+    }
 
-        int cur_state = 0; //   (   )
-        vector<move_pos> res; //   
+    // Запуск размышления бота color на глубину depth, пока соперник думает над ходом в позиции pos.
+    // Фоновый поток сначала неглубоко оценивает все ходы соперника, затем просчитывает ответы на них
+    // на полную глубину, начиная с ходов, худших для бота. Во время размышления нельзя вызывать
+    // другие функции поиска, кроме stop_ponder.
+    void start_ponder(const bool color, const Position& pos, const int depth) {
+        stop_ponder();
+        ponder->results.clear();
+        ponder->cancel = false;
+        ponder->color = color;
+        ponder->depth = depth;
+        ponder->th = thread(&Logic::ponder_search, this, color, pos, depth);
+    }
 
-        //      
-        do {
-            res.push_back(next_move[cur_state]); //     
-            cur_state = next_best_state[cur_state]; //    
-        } while (cur_state != -1 && next_move[cur_state].x != -1); // ,     
+    // Остановка размышления. Уже найденные ответы сохраняются для find_best_turns
+    void stop_ponder() {
+        if (!ponder->th.joinable())
+            return;
+        ponder->cancel = true;
+        ponder->th.join();
+    }
 
-        return res; //    
+    // Все позиции, в которые игрок color может перейти из позиции pos за один полный ход
+    // (серия ударов считается одним ходом; разные серии, ведущие в одну позицию, - одна позиция)
+    vector<Position> find_full_turns(const bool color, const Position& pos) {
+        vector<Position> res;
+        find_full_turns(states[0], pos, color, res);
+        return res;
     }
 
 private:
-    //     
-    double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state,
-        double alpha = -1) {
-        next_best_state.push_back(-1); //     
-        next_move.emplace_back(-1, -1, -1, -1); //    ()
+    // Выбор хода: дебютная книга, ответ из размышления или перебор.
+    // Если задан BotTimeMS, глубина увеличивается на 1 до Max_depth, пока не закончится время на ход
+    MoveList choose_turns(const bool color, const Position& pos) {
+        // Позиция из дебютной книги не перебирается
+        const auto book_start = chrono::steady_clock::now();
+        auto book_line = find_book_turns(color, pos);
+        move_stats.book_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - book_start).count();
+        if (!book_line.empty()) {
+            move_stats.source = "book";
+            ponder->results.clear();
+            return book_line;
+        }
+        // Ответ на сделанный ход уже посчитан во время размышления в ходе соперника
+        for (const auto& res : ponder->results) {
+            if (res.first == pos && ponder->color == color && ponder->depth == Max_depth && !res.second.empty()) {
+                auto line = res.second;
+                move_stats.source = "ponder";
+                move_stats.depth = Max_depth;
+                ponder->results.clear();
+                return line;
+            }
+        }
+        ponder->results.clear();
+
+        bot_color = color; // Запоминаем сторону, за которую считается оценка
+        clear_ordering();  // Ходы-убийцы и история от прошлого поиска устарели
+        root_best = move_pos(-1, -1, -1, -1);
+        if (!time_limit_ms) { // Поиск на фиксированную глубину
+            return search_iteration(pos, color);
+        }
+
+        const auto start = chrono::steady_clock::now();
+        const int max_depth = Max_depth; // Глубина, ограниченная уровнем бота
+        search_deadline = start + chrono::milliseconds(time_limit_ms);
+        MoveList res; // Последовательность последней завершенной итерации
+        for (Max_depth = 0; Max_depth <= max_depth; ++Max_depth) {
+            can_stop = !res.empty(); // Первую итерацию всегда доводим до конца, чтобы был ход
+            const MoveList res_now = search_iteration(pos, color);
+            if (search_stopped())
+                break;
+            res = res_now;
+            if (res.empty())
+                break;
+            root_best = res.front(); // Лучший ход итерации просматривается первым в следующей
+            // Следующая итерация дольше предыдущих вместе взятых, не начинаем её после половины времени
+            if (chrono::steady_clock::now() - start > chrono::milliseconds(time_limit_ms / 2))
+                break;
+        }
+        Max_depth = max_depth;
+        can_stop = false;
+        for (auto& st : states) {
+            st.stop = false;
+        }
+        return res;
+    }
+
+    // Итерация перебора из корня на глубину Max_depth с учетом времени в статистике хода
+    MoveList search_iteration(const Position& pos, const bool color) {
+        const auto start = chrono::steady_clock::now();
+        MoveList res = search_root(pos, color);
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        move_stats.search_ms += ms;
+        move_stats.iteration_ms[min(Max_depth, STATS_DEPTHS - 1)] = ms;
+        if (!search_stopped()) {
+            move_stats.depth = Max_depth;
+            move_stats.score = last_root_score;
+        }
+        return res;
+    }
+
+    // Начало хода: счетчики потоков обнуляются, узлы считаются от текущих значений
+    void start_stats(const bool color) {
+        move_stats = MoveStats();
+        move_stats.color = color;
+        move_stats.threads = int(states.size());
+        move_stats.nodes = nodes();
+        move_stats.qnodes = qnodes();
+        move_stats.stand_pats = stand_pats();
+        root_researches = 0;
+#if SEARCH_STATS
+        for (auto& st : states) {
+            st.counters = SearchCounters();
+        }
+#endif
+    }
+
+    // Конец хода: счетчики всех потоков складываются один раз
+    void finish_stats(const chrono::steady_clock::time_point start) {
+        move_stats.total_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        move_stats.nodes = nodes() - move_stats.nodes;
+        move_stats.qnodes = qnodes() - move_stats.qnodes;
+        move_stats.stand_pats = stand_pats() - move_stats.stand_pats;
+        move_stats.researches = root_researches;
+#if SEARCH_STATS
+        for (const auto& st : states) {
+            move_stats.counters.add(st.counters);
+        }
+#endif
+    }
 
-        double best_score = -1; //    
+    // Перебор в потоке размышления
+    void ponder_search(const bool color, const Position pos, const int depth) {
+        vector<Position> replies; // Позиции после всех ходов соперника
+        find_full_turns(states[0], pos, 1 - color, replies);
+        bot_color = color;
+        clear_ordering();
+        can_stop = true; // Перебор прерывается только по запросу остановки
+        search_deadline = chrono::steady_clock::time_point::max();
 
-        if (state != 0) { //     ,   
-            find_turns(x, y, mtx);
+        // Неглубокая оценка: вероятнее всего соперник выберет ход, худший для бота
+        vector<pair<double, size_t>> order;
+        Max_depth = min(depth, 2);
+        for (size_t i = 0; i < replies.size() && !ponder->cancel; ++i) {
+            double score = -1;
+            root_best = move_pos(-1, -1, -1, -1);
+            search_root(replies[i], color, &score);
+            order.emplace_back(score, i);
         }
+        stable_sort(order.begin(), order.end(),
+            [](const pair<double, size_t>& a, const pair<double, size_t>& b) { return a.first < b.first; });
 
-        auto turns_now = turns; //   
-        bool have_beats_now = have_beats; //    
+        Max_depth = depth;
+        for (const auto& item : order) {
+            root_best = move_pos(-1, -1, -1, -1);
+            auto line = search_root(replies[item.second], color);
+            if (ponder->cancel || search_stopped())
+                break;
+            ponder->results.emplace_back(replies[item.second], line);
+        }
+        can_stop = false;
+        for (auto& st : states) {
+            st.stop = false;
+        }
+    }
+
+    // Все позиции, в которые игрок color может перейти за один полный ход (вместе с сериями ударов)
+    void find_full_turns(SearchState& st, const Position& pos, const bool color, vector<Position>& res) const {
+        MoveList turns_now;
+        const bool have_beats_now = find_turns(st, color, pos, turns_now);
+        for (const auto& turn : turns_now) {
+            if (have_beats_now) {
+                find_full_beats(st, pos.make_turn(turn), turn.x2, turn.y2, res);
+            }
+            else {
+                res.push_back(pos.make_turn(turn));
+            }
+        }
+    }
+
+    // Продолжения серии ударов фигурой на клетке (x, y)
+    void find_full_beats(SearchState& st, const Position& pos, const POS_T x, const POS_T y,
+        vector<Position>& res) const {
+        MoveList turns_now;
+        if (!find_turns(x, y, pos, turns_now)) {
+            if (find(res.begin(), res.end(), pos) == res.end()) { // Разные серии могут привести в одну позицию
+                res.push_back(pos);
+            }
+            return;
+        }
+        for (const auto& turn : turns_now) {
+            find_full_beats(st, pos.make_turn(turn), turn.x2, turn.y2, res);
+        }
+    }
+
+    // Поиск лучшей последовательности ходов на глубину Max_depth.
+    // Если та же позиция уже перебиралась (углубление по времени, повторный поиск), сначала ищем в окне
+    // стремления вокруг прошлой оценки; при выходе оценки за окно перебор повторяется с открытой границей.
+    MoveList search_root(const Position& pos, const bool color, double* best_score = nullptr) {
+        SearchState& st = states[0];
+        if (no_random) { // Порядок ходов из корня не зависит от того, какие узлы поток смотрел раньше
+            st.rand_eng = default_random_engine(seed);
+        }
+        const EvalTerms ev = evaluator.init(pos); // Дальше слагаемые оценки только обновляются ходами
+        MoveList turns;
+        const bool have_beats = find_turns(st, color, pos, turns); // Ходы из корня
+        // В корне первым смотрим лучший ход прошлой итерации
+        if (root_best.x != -1) {
+            order_turns(st, turns, pos, -1, cell_to_sq(root_best.x, root_best.y),
+                cell_to_sq(root_best.x2, root_best.y2));
+        }
+        else {
+            order_turns(st, turns, pos, -1, -1, -1);
+        }
+
+        const uint64_t key = zobrist_hash(pos, color, bot_color);
+        double alpha = -1, beta = INF + 1;
+        // Окно только для оценок материала: выигрыш, проигрыш и результаты таблиц окончаний ищутся полностью
+        if (optimization != "O0" && key == last_root_key && last_root_score > 1e-3 && last_root_score < 1e3) {
+            alpha = last_root_score / ASPIRATION_WINDOW;
+            beta = last_root_score * ASPIRATION_WINDOW;
+        }
+        while (true) {
+            RootSearch rs;
+            rs.pos = pos;
+            rs.ev = ev;
+            rs.turns = turns;
+            rs.have_beats = have_beats;
+            rs.alpha = alpha;
+            rs.beta = beta;
+            search_root_window(st, rs, color);
+            if (search_stopped() || turns.empty()) {
+                return rs.best_line;
+            }
+            if (rs.best_index == -1) { // Все ходы не лучше alpha: опускаем нижнюю границу
+                alpha = -1;
+                ++root_researches;
+                continue;
+            }
+            if (rs.best_score >= beta) { // Оценка - только нижняя граница: поднимаем верхнюю
+                beta = INF + 1;
+                ++root_researches;
+                continue;
+            }
+            last_root_key = key;
+            last_root_score = rs.best_score;
+            if (best_score) {
+                *best_score = rs.best_score;
+            }
+            return rs.best_line; // Возвращаем результирующую последовательность ходов
+        }
+    }
+
+    // Перебор ходов из корня в окне rs.alpha..rs.beta.
+    // Ходы из корня делятся между потоками: каждый поток берет следующий непросмотренный ход,
+    // а граница alpha в корне общая и растет по мере нахождения лучших ходов.
+    // Если включено разделение внутренних узлов (SplitDepth), первый ход из корня основной поток смотрит
+    // один, а остальные потоки в это время крадут ходы из его точек разделения.
+    void search_root_window(SearchState& st, RootSearch& rs, const bool color) {
+        const bool split = split_depth > 0 && states.size() > 1;
+        rs.open = !split;
+
+        vector<thread> helpers; // Дополнительные потоки (основной поток тоже перебирает ходы)
+        for (size_t t = 1; t < states.size() && (split || t < rs.turns.size()); ++t) {
+            helpers.emplace_back(&Logic::search_root_turns, this, ref(states[t]), ref(rs), color);
+        }
+        if (split && !rs.turns.empty()) {
+            st.root = &rs;
+            search_root_turn(st, rs, color, rs.next++);
+            rs.open = true;
+        }
+        search_root_turns(st, rs, color);
+        for (auto& th : helpers) {
+            th.join();
+        }
+    }
 
-        if (!have_beats_now && state != 0) { //   ,    
-            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
+    // Работа потока st при переборе из корня: берет непросмотренные ходы из корня,
+    // а когда их нет (или первый ход еще не просмотрен) - крадет задачи из очередей других потоков
+    void search_root_turns(SearchState& st, RootSearch& rs, const bool color) {
+        st.root = &rs;
+        const int n = int(rs.turns.size());
+        while (rs.done.load() < n && !rs.stop.load()) {
+            if (rs.open.load() && rs.next.load() < n) {
+                const int i = rs.next++;
+                if (i < n) {
+                    search_root_turn(st, rs, color, i);
+                }
+                continue;
+            }
+            SplitTask task;
+            if (steal_task(st, nullptr, task)) {
+                run_task(st, task);
+            }
+            else if (states.size() > 1) {
+                this_thread::yield();
+            }
         }
+        st.root = nullptr;
+    }
 
-        vector<move_pos> best_moves; //   
-        vector<int> best_states;     //   
+    // Просмотр хода из корня с индексом i
+    void search_root_turn(SearchState& st, RootSearch& rs, const bool color, const int i) {
+        const move_pos turn = rs.turns[i];
+        const double alpha = rs.alpha.load();
+        if (alpha >= rs.beta) { // Оценка корня уже вышла за окно стремления, перебор будет повторен
+            ++rs.done;
+            return;
+        }
+        st.next_best_state.clear(); // Очищаем список следующих состояний
+        st.next_move.clear();       // Очищаем список следующих ходов
 
-        for (auto turn : turns_now) { //    
-            size_t next_state = next_move.size(); //   
+        st.pos = rs.pos; // Перебор потока начинается из позиции корня
+        st.ev = rs.ev;
+        SEARCH_STAT(st.series = 0);
+        MoveUndo undo;
+        make_move(st, turn, undo);
+        double score;
+        if (rs.have_beats) { // Если есть удары, продолжаем цепочку
+            score = find_first_best_turn(st, color, turn.x2, turn.y2, 0, alpha, rs.beta);
+        }
+        else if (i == 0 || alpha < 0 || optimization == "O0") { // Первый ход - с полным окном
+            score = find_best_turns_rec(st, 1 - color, 0, alpha, rs.beta);
+        }
+        else { // Остальные сначала проверяем нулевым окном: лучше ли ход найденного
+            score = find_best_turns_rec(st, 1 - color, 0, alpha, nextafter(alpha, double(INF)));
+            if (score > alpha && !search_aborted(st)) { // Ход лучше - точная оценка в полном окне
+                score = find_best_turns_rec(st, 1 - color, 0, alpha, rs.beta);
+            }
+        }
+        unmake_move(st, turn, undo);
+        if (search_aborted(st)) { // Время вышло, результат итерации не используется
+            return;
+        }
+        ++rs.done;
+        if (score <= alpha) { // Ход не лучше найденного, его оценка - только верхняя граница
+            return;
+        }
 
-            double score;
-            if (have_beats_now) { //   ,  
-                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, next_state, best_score);
+        // Оценка точная. При равенстве выбираем ход с меньшим индексом, как при переборе в одном потоке
+        lock_guard<mutex> guard(rs.lock);
+        if (score > rs.best_score || (score == rs.best_score && i < rs.best_index)) {
+            rs.best_score = score;
+            rs.best_index = i;
+            rs.best_line.clear();
+            rs.best_line.push_back(turn);
+            // Собираем продолжение серии ударов из найденных состояний
+            for (int cur = 0; cur != -1 && cur < int(st.next_move.size()) && st.next_move[cur].x != -1;
+                cur = st.next_best_state[cur]) {
+                rs.best_line.push_back(st.next_move[cur]);
             }
-            else { //   ,    
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
+            // Граница чуть меньше лучшей оценки: ход с такой же оценкой получит точную оценку
+            rs.alpha.store(nextafter(score, -double(INF)));
+        }
+    }
+
+    // Был ли прерван по времени хотя бы один поток
+    bool search_stopped() const {
+        for (const auto& st : states) {
+            if (st.stop)
+                return true;
+        }
+        return false;
+    }
+
+    // Оценка результата из таблиц окончаний со стороны бота (ходящая сторона - бот на нечетной глубине).
+    // Быстрая победа лучше долгой, долгое поражение лучше быстрого; ничья равна равному материалу
+    double endgame_score(const EndgameResult res, const int distance, const size_t depth) const {
+        if (res == EndgameResult::DRAW)
+            return 1;
+        const bool bot_wins = (res == EndgameResult::WIN) == bool(depth % 2);
+        const double plies = double(depth) + distance; // Полуходов от корня до конца игры
+        return bot_wins ? INF - plies : (plies + 1) * ENDGAME_LOSS_STEP;
+    }
+
+    // Сдвиг расстояния до конца игры в оценке из таблиц окончаний на plies полуходов (другие оценки не меняются)
+    static double shift_endgame_score(const double score, const double plies) {
+        if (score >= INF - ENDGAME_SCORE_PLIES && score < INF)
+            return score - plies;
+        if (score > 0 && score <= ENDGAME_SCORE_PLIES * ENDGAME_LOSS_STEP)
+            return score + plies * ENDGAME_LOSS_STEP;
+        return score;
+    }
+
+    // В таблице транспозиций расстояние до конца игры хранится от самой позиции, а не от корня: та же позиция
+    // встречается на другой глубине и в следующих ходах (хэш не зависит от глубины, таблица не очищается между ходами)
+    static double tt_score_store(const double score, const size_t depth) {
+        return shift_endgame_score(score, -double(depth));
+    }
+
+    static double tt_score_probe(const double score, const size_t depth) {
+        return shift_endgame_score(score, double(depth));
+    }
+
+    // Рекурсивный поиск продолжения серии ударов хода из корня
+    double find_first_best_turn(SearchState& st, const bool color, const POS_T x, const POS_T y, size_t state,
+        double alpha = -1, const double beta = INF + 1) {
+        st.next_best_state.push_back(-1); // Добавляем новое состояние в список
+        st.next_move.emplace_back(-1, -1, -1, -1); // Добавляем новый ход (пустой)
+
+        double best_score = -1; // Лучшая оценка пока отсутствует
+
+        MoveList turns_now; // Продолжения серии ударов
+        const bool have_beats_now = find_turns(x, y, st.pos, turns_now);
+
+        if (!have_beats_now) { // Если нет ударов, переходим к следующему уровню
+            return find_best_turns_rec(st, 1 - color, 0, alpha, beta);
+        }
+
+        order_turns(st, turns_now, st.pos, -1, -1, -1);
+
+        for (const auto& turn : turns_now) { // Перебор всех возможных ходов
+            size_t next_state = st.next_move.size(); // Индекс следующего состояния
+
+            // Продолжаем цепочку
+            MoveUndo undo;
+            make_move(st, turn, undo);
+            double score = find_first_best_turn(st, color, turn.x2, turn.y2, next_state, max(alpha, best_score), beta);
+            unmake_move(st, turn, undo);
+
+            if (search_aborted(st)) { // Время вышло, результат итерации не используется
+                return best_score;
             }
 
-            if (score > best_score) { //   
+            if (score > best_score) { // Обновляем лучший ход
                 best_score = score;
-                next_best_state[state] = (have_beats_now ? int(next_state) : -1); //   
-                next_move[state] = turn; //  
+                st.next_best_state[state] = int(next_state); // Сохраняем следующее состояние
+                st.next_move[state] = turn; // Сохраняем ход
             }
+            if (best_score >= beta) // Оценка вышла за окно стремления
+                break;
         }
 
-        return best_score; //   
+        return best_score; // Возвращаем лучшую оценку
     }
 
-    //       
-    double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1,
+    // Рекурсивный поиск лучших ходов с использованием минимакса
+    // Позиция узла - позиция перебора потока st.pos, после просмотра узла она остается прежней
+    double find_best_turns_rec(SearchState& st, const bool color, const size_t depth, double alpha = -1,
         double beta = INF + 1, const POS_T x = -1, const POS_T y = -1) {
-        if (depth == Max_depth) { //    ,   
-            return calc_score(mtx, (depth % 2 == color));
+        const Position& pos = st.pos;
+        count_node(st);
+        if (search_aborted(st)) {
+            return 0;
+        }
+        // Точный результат окончания из таблиц (только для позиций в начале хода)
+        if (x == -1 && endgame.enabled() && popcount(pos.occupied()) <= endgame.max_pieces()) {
+            int distance = 0;
+            const EndgameResult res = endgame.probe(pos, color, distance);
+            if (res != EndgameResult::UNKNOWN) {
+                SEARCH_STAT(++st.counters.endgame_hits);
+                return endgame_score(res, distance, depth);
+            }
+        }
+        if (int(depth) == Max_depth) { // Достигнута максимальная глубина: оценка позиции после размена ударами
+            if (quiescence_enabled)
+                return quiescence(st, color, depth, alpha, beta);
+            SEARCH_STAT(++st.counters.evals);
+            return evaluator.score(st.ev, (depth % 2 == color));
         }
 
-        if (x != -1) { //    ,     
-            find_turns(x, y, mtx);
+        // Узел уже опровергнут лучшим ходом корня: корень отбросит любую оценку не больше своей границы.
+        // Смотреть узел с пустым окном нельзя - отсечения в потомках дадут неверные границы
+        if (update_root_alpha(st, depth, alpha) && alpha >= beta) {
+            return alpha;
         }
-        else { //      
-            find_turns(color, mtx);
+        const int depth_left = Max_depth - int(depth); // Оставшаяся глубина перебора
+        uint64_t key = 0; // Хэш позиции для таблицы транспозиций
+        int tt_from = -1, tt_to = -1; // Лучший ход из таблицы транспозиций
+
+        // Проверяем таблицу транспозиций (только для позиций в начале хода, не внутри серии ударов).
+        // В детерминированном режиме оценки с большей глубины не используются: при многопоточном
+        // переборе их наличие зависит от того, какой поток успел записать позицию раньше
+        if (x == -1 && tt.enabled()) {
+            key = zobrist_hash(pos, color, bot_color);
+            TTEntry entry;
+            if (tt.probe(key, entry)) {
+                tt_from = entry.from;
+                tt_to = entry.to;
+                entry.score = tt_score_probe(entry.score, depth);
+                const bool depth_ok = (entry.depth == depth_left) ||
+                    (entry.depth > depth_left && !no_random);
+                if (depth_ok && (entry.bound == Bound::EXACT || (entry.bound == Bound::LOWER && entry.score >= beta) ||
+                    (entry.bound == Bound::UPPER && entry.score <= alpha))) {
+                    SEARCH_STAT(++st.counters.tt_cutoffs);
+                    return entry.score;
+                }
+            }
         }
 
-        auto turns_now = turns; //   
-        bool have_beats_now = have_beats; //    
+        // Если указаны конкретные координаты, ищем ходы только для них, иначе - для всего игрока
+        MoveList turns_now;
+        const bool have_beats_now = x != -1 ? find_turns(x, y, pos, turns_now) : find_turns(st, color, pos, turns_now);
 
-        if (!have_beats_now && x != -1) { //   ,    
-            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta);
+        if (!have_beats_now && x != -1) { // Если нет ударов, переходим к следующему уровню
+            return find_best_turns_rec(st, 1 - color, depth + 1, alpha, beta);
         }
 
-        if (turns.empty()) { //   ,   
+        if (turns_now.empty()) { // Если ходов нет, возвращаем соответствующую оценку
             return (depth % 2 ? 0 : INF);
         }
+        if (x == -1) { // Продолжение серии ударов - тот же ход, ветвление по глубине не меняет
+            SEARCH_STAT(st.counters.expand(depth, turns_now.size()));
+        }
 
-        double min_score = INF + 1; //  
-        double max_score = -1;      //  
+        order_turns(st, turns_now, pos, int(depth), tt_from, tt_to); // Упорядочиваем ходы для лучших отсечений
 
-        for (auto turn : turns_now) { //    
-            double score = 0.0;
+        NodeScores node; // Окно и лучшие оценки узла
+        node.alpha = node.alpha_orig = alpha;
+        node.beta = beta;
+        const double beta_orig = beta; // Исходное окно для определения типа оценки
+        bool cutoff = false;
 
-            if (!have_beats_now && x == -1) { //       
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);
+        const bool batch = leaf_batch(pos, depth_left, have_beats_now);
+        LeafBatch leaves; // Разбор очередных LEAF_BATCH_SIZE листьев (только при batch)
+        for (size_t i = 0; i < turns_now.size() && !cutoff; ++i) { // Перебор всех возможных ходов
+            // Старшие братья ждут: когда первый ход просмотрен, остальные можно отдать другим потокам
+            if (i == 1 && x == -1 && split_depth > 0 && depth_left >= split_depth && states.size() > 1 && st.root) {
+                cutoff = search_split(st, color, depth, turns_now, have_beats_now, node);
+                break;
+            }
+            const move_pos& turn = turns_now[i];
+            int leaf_moves = -1; // Число ходов листа без ударов (-1 - лист смотрится обычным перебором)
+            if (batch) {
+                if (i % LEAF_BATCH_SIZE == 0) {
+                    scan_leaves(pos, color, turns_now, i, leaves);
+                }
+                if (!leaves.beats[i % LEAF_BATCH_SIZE]) {
+                    leaf_moves = int(leaves.moves[i % LEAF_BATCH_SIZE]);
+                }
+            }
+            const double score = search_turn(st, color, depth, turn, have_beats_now, node.alpha, node.beta, i == 0,
+                leaf_moves);
+            if (search_aborted(st)) { // Перебор прерван, оценка недостоверна и не сохраняется
+                return 0;
             }
-            else { //    
-                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2);
+            cutoff = update_node(st, node, depth, turn, score);
+            if (cutoff) {
+                SEARCH_STAT(st.counters.cutoff(i));
             }
+            if (cutoff && !have_beats_now) { // Тихий ход, вызвавший отсечение, запоминаем для других позиций
+                update_ordering(st, turn, int(depth), depth_left);
+            }
+        }
+        if (search_aborted(st)) { // Перебор прерван во время работы других потоков над узлом
+            return 0;
+        }
+        // Отсечение только из-за границы корня: ни один ход не опустил оценку ниже beta, поэтому min_score -
+        // нижняя граница, а не верхняя. Как и при входе в узел, оценка не сохраняется и корнем отбрасывается
+        if (cutoff && !(depth % 2) && node.min_score >= beta_orig) {
+            return node.alpha;
+        }
 
-            min_score = min(min_score, score); //   
-            max_score = max(max_score, score); //   
+        const double res = (depth % 2 ? node.max_score : node.min_score);
+        if (key) { // Сохраняем оценку с типом, определенным по исходному окну (при отсечении - граница)
+            const Bound bound = cutoff ? (depth % 2 ? Bound::LOWER : Bound::UPPER) :
+                (res <= node.alpha_orig ? Bound::UPPER : (res >= beta_orig ? Bound::LOWER : Bound::EXACT));
+            tt.store(key, depth_left, bound, tt_score_store(res, depth), node.best_turn);
+        }
+        return res; // Возвращаем результат
+    }
 
-            // - 
-            if (depth % 2) { //      
-                alpha = max(alpha, max_score);
+    // Форсированный перебор за пределом глубины: пока у ходящей стороны есть удары, перебираются только они
+    // (удар обязателен, поэтому отказаться от него и взять статическую оценку нельзя). Как только ударов
+    // нет, позиция спокойная и оценивается статически (stand pat) - тихие ходы за пределом глубины
+    // не смотрятся. Каждый удар снимает фигуру, поэтому перебор конечен. Без таблицы транспозиций.
+    double quiescence(SearchState& st, const bool color, const size_t depth, double alpha, double beta,
+        const POS_T x = -1, const POS_T y = -1) {
+        if (int(depth) > Max_depth || x != -1) { // Узел на пределе глубины уже посчитан в find_best_turns_rec
+            count_node(st);
+            if (search_aborted(st)) {
+                return 0;
+            }
+        }
+        ++st.qnodes;
+        MoveList turns_now;
+        const bool have_beats_now = x != -1 ? find_turns(x, y, st.pos, turns_now) : find_turns(st, color, st.pos, turns_now);
+        if (!have_beats_now) {
+            if (x != -1) { // Серия ударов закончена, ход соперника
+                return quiescence(st, 1 - color, depth + 1, alpha, beta);
             }
-            else { //      
-                beta = min(beta, min_score);
+            if (turns_now.empty()) { // Ходов нет - поражение ходящей стороны
+                return (depth % 2 ? 0 : INF);
             }
+            ++st.stand_pats;
+            SEARCH_STAT(++st.counters.evals);
+            return evaluator.score(st.ev, (depth % 2 == color));
+        }
 
-            if (optimization != "O0" && alpha >= beta) { //    
-                return (depth % 2 ? max_score + 1 : min_score - 1);
+        order_turns(st, turns_now, st.pos, -1, -1, -1); // Удары по ценности побитой фигуры
+        double best = (depth % 2 ? -1 : INF + 1);
+        for (const auto& turn : turns_now) {
+            MoveUndo undo;
+            make_move(st, turn, undo);
+            const double score = quiescence(st, color, depth, alpha, beta, turn.x2, turn.y2);
+            unmake_move(st, turn, undo);
+            if (search_aborted(st)) {
+                return 0;
+            }
+            if (depth % 2) { // Максимизирующий игрок (бот)
+                best = max(best, score);
+                alpha = max(alpha, best);
             }
+            else {
+                best = min(best, score);
+                beta = min(beta, best);
+            }
+            if (optimization != "O0" && alpha >= beta)
+                break;
         }
+        return best;
+    }
 
-        return (depth % 2 ? max_score : min_score); //  
+    // Можно ли разобрать листья узла пакетом (leaf_scan): тихие ходы на последнем уровне, после которых
+    // форсированный перебор ударов начинается с генерации всех ходов листа, и без таблиц окончаний
+    bool leaf_batch(const Position& pos, const int depth_left, const bool beats) const {
+        return depth_left == 1 && !beats && quiescence_enabled &&
+            !(endgame.enabled() && popcount(pos.occupied()) <= endgame.max_pieces());
     }
 
-public:
-    //     
-    void find_turns(const bool color) {
-        find_turns(color, board->get_board()); //        
+    // Разбор листьев после ходов turns[first..first + LEAF_BATCH_SIZE) позиции pos (ходит color). Ходы тихие,
+    // поэтому в листе меняется только маска фигур соперника ходящего: одна фигура переходит с клетки на клетку
+    void scan_leaves(const Position& pos, const bool color, const MoveList& turns, const size_t first,
+        LeafBatch& leaves) const {
+        const uint32_t leaf_own = pos.pieces(!color), own = pos.pieces(color);
+        for (size_t i = 0; i < size_t(LEAF_BATCH_SIZE); ++i) {
+            leaves.men[i] = leaf_own & ~pos.kings;
+            leaves.kings[i] = leaf_own & pos.kings;
+            leaves.opp[i] = own;
+            if (first + i < turns.size()) {
+                const move_pos& turn = turns[first + i];
+                leaves.opp[i] ^= (uint32_t(1) << cell_to_sq(turn.x, turn.y)) |
+                    (uint32_t(1) << cell_to_sq(turn.x2, turn.y2));
+            }
+        }
+        leaf_scan(leaves, !color, evaluator.get_kernel());
+    }
+
+    // Лист без ударов на последнем уровне, разобранный пакетом: то же, что find_best_turns_rec и quiescence
+    // для этой позиции (те же счетчики узлов и оценка), но без генерации ходов. moves - число тихих ходов.
+    // Перемешивание ходов в find_turns все равно повторяется: от последовательности случайных чисел зависит
+    // порядок ходов в остальных узлах, и дерево перебора должно остаться тем же
+    double quiet_leaf(SearchState& st, const bool color, const size_t depth, const int moves) {
+        count_node(st);
+        if (search_aborted(st)) {
+            return 0;
+        }
+        ++st.qnodes;
+        unsigned char order[MAX_MOVES] = {};
+        shuffle(order, order + moves, st.rand_eng);
+        if (moves == 0) { // Ходов нет - поражение ходящей стороны
+            return (depth % 2 ? 0 : INF);
+        }
+        ++st.stand_pats;
+        SEARCH_STAT(++st.counters.evals);
+        return evaluator.score(st.ev, (depth % 2 == color));
     }
 
-    void find_turns(const POS_T x, const POS_T y) {
-        find_turns(x, y, board->get_board()); //          
+    // Учет узла в счетчике: раз в 1024 узла проверяем время на ход и запрос остановки размышления
+    void count_node(SearchState& st) {
+        if ((++st.nodes & 1023) == 0 && can_stop &&
+            (ponder->cancel.load(memory_order_relaxed) || chrono::steady_clock::now() > search_deadline)) {
+            st.stop = true;
+            if (st.root) {
+                st.root->stop = true; // Останавливаем и остальные потоки
+            }
+        }
     }
 
-private:
-    //       
-    void find_turns(const bool color, const vector<vector<POS_T>>& mtx) {
-        vector<move_pos> res_turns; //   
-        bool have_beats_before = false; //      
-        for (POS_T i = 0; i < 8; ++i) {
-            for (POS_T j = 0; j < 8; ++j) {
-                //      , 
-                if (mtx[i][j] && mtx[i][j] % 2 != color) {
-                    find_turns(i, j, mtx); //       
-                    if (have_beats && !have_beats_before) { //   ,   
-                        have_beats_before = true;
-                        res_turns.clear();
-                    }
-                    if ((have_beats_before && have_beats) || !have_beats_before) { //  
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
-                    }
-                }
+    // Оценка хода turn из узла: следующий уровень или продолжение серии ударов.
+    // Перебор с главным вариантом (PVS): первый ход узла (full_window) смотрится в окне alpha..beta,
+    // остальные - сначала в нулевом окне, которое только отвечает, лучше ли ход уже найденного.
+    // Если лучше, ход пересматривается в полном окне ради точной оценки.
+    // leaf_moves >= 0 - ход ведет в лист без ударов с таким числом тихих ходов (пакетный разбор, leaf_batch)
+    double search_turn(SearchState& st, const bool color, const size_t depth, const move_pos& turn, const bool beats,
+        const double alpha, const double beta, const bool full_window, const int leaf_moves = -1) {
+        MoveUndo undo;
+        make_move(st, turn, undo);
+        double score;
+        if (full_window || optimization == "O0") { // В O0 нет отсечений, и нулевое окно ничего не дает
+            score = search_child(st, color, depth, turn, beats, alpha, beta, leaf_moves);
+        }
+        else if (depth % 2) { // Бот: лучше ли ход, чем alpha
+            score = search_child(st, color, depth, turn, beats, alpha, nextafter(alpha, double(INF)), leaf_moves);
+            if (score > alpha && score < beta && !search_aborted(st)) {
+                score = search_child(st, color, depth, turn, beats, alpha, beta, leaf_moves);
+            }
+        }
+        else { // Соперник: меньше ли оценка, чем beta
+            score = search_child(st, color, depth, turn, beats, nextafter(beta, -1.0), beta, leaf_moves);
+            if (score < beta && score > alpha && !search_aborted(st)) {
+                score = search_child(st, color, depth, turn, beats, alpha, beta, leaf_moves);
+            }
+        }
+        unmake_move(st, turn, undo);
+        return score;
+    }
+
+    // Оценка позиции после хода turn (ход уже сделан в st.pos)
+    double search_child(SearchState& st, const bool color, const size_t depth, const move_pos& turn, const bool beats,
+        const double alpha, const double beta, const int leaf_moves = -1) {
+        if (leaf_moves >= 0) { // Лист уже разобран пакетом
+            return quiet_leaf(st, 1 - color, depth + 1, leaf_moves);
+        }
+        return beats ?
+            find_best_turns_rec(st, color, depth, alpha, beta, turn.x2, turn.y2) : // Продолжаем цепочку ударов
+            find_best_turns_rec(st, 1 - color, depth + 1, alpha, beta);            // Переходим к следующему уровню
+    }
+
+    // Ход turn в позиции перебора потока st: доска и слагаемые оценки меняются на месте
+    void make_move(SearchState& st, const move_pos& turn, MoveUndo& undo) const {
+#if SEARCH_STATS
+        // Серия ударов продолжается, если фигура снова бьет с клетки, на которую пришла последним ходом
+        undo.series = st.series;
+        undo.series_sq = st.series_sq;
+        if (turn.xb != -1) {
+            st.series = cell_to_sq(turn.x, turn.y) == st.series_sq ? st.series + 1 : 1;
+            st.series_sq = cell_to_sq(turn.x2, turn.y2);
+            st.counters.max_series = max(st.counters.max_series, st.series);
+        }
+        else {
+            st.series_sq = -1;
+        }
+#endif
+        undo.ev = st.ev;
+        evaluator.update(st.ev, st.pos, turn); // Разность для передвинутой, превращенной и побитой фигуры
+        st.pos.make(turn, undo.board);
+    }
+
+    // Отмена хода turn, сделанного make_move
+    void unmake_move(SearchState& st, const move_pos& turn, const MoveUndo& undo) const {
+        st.pos.unmake(turn, undo.board);
+        st.ev = undo.ev;
+#if SEARCH_STATS
+        st.series = undo.series;
+        st.series_sq = undo.series_sq;
+#endif
+    }
+
+    // Учет оценки хода turn в узле глубины depth. Возвращает true, если выполнено условие отсечения
+    bool update_node(const SearchState& st, NodeScores& node, const size_t depth, const move_pos& turn,
+        const double score) const {
+        if (depth % 2 ? score > node.max_score : score < node.min_score) { // Запоминаем лучший ход
+            node.best_turn = turn;
+        }
+        node.min_score = min(node.min_score, score); // Обновляем минимальную оценку
+        node.max_score = max(node.max_score, score); // Обновляем максимальную оценку
+
+        // Альфа-бета отсечение
+        if (depth % 2) { // Если текущий уровень принадлежит максимизирующему игроку
+            node.alpha = max(node.alpha, node.max_score);
+        }
+        else { // Если текущий уровень принадлежит минимизирующему игроку
+            node.beta = min(node.beta, node.min_score);
+            if (update_root_alpha(st, depth, node.alpha)) { // Другой поток нашел лучший ход в корне
+                node.alpha_orig = node.alpha;
+            }
+        }
+        return optimization != "O0" && node.alpha >= node.beta;
+    }
+
+    // Перебор ходов узла, начиная со второго, вместе с другими потоками.
+    // Владелец выкладывает ходы задачами в свою очередь и забирает их сам, пока их не украли;
+    // дожидаясь украденных задач, он помогает только с задачами внутри этого же узла.
+    // Возвращает true, если в узле произошло отсечение.
+    bool search_split(SearchState& st, const bool color, const size_t depth, const MoveList& turns_now,
+        const bool have_beats_now, NodeScores& node) {
+        SplitPoint sp;
+        sp.parent = st.split;
+        sp.pos = st.pos;
+        sp.ev = st.ev;
+        sp.color = color;
+        sp.depth = depth;
+        sp.have_beats = have_beats_now;
+        sp.turns = &turns_now;
+        sp.node = node;
+        sp.pending = int(turns_now.size()) - 1;
+        for (int i = int(turns_now.size()) - 1; i >= 1; --i) { // Ход с индексом 1 окажется в конце очереди
+            st.queue->push({ &sp, i });
+        }
+        while (sp.pending.load() > 0) {
+            SplitTask task;
+            if (st.queue->pop(&sp, task) || steal_task(st, &sp, task)) {
+                run_task(st, task);
+            }
+            else {
+                this_thread::yield();
             }
         }
-        turns = res_turns; //   
-        shuffle(turns.begin(), turns.end(), rand_eng); //    
-        have_beats = have_beats_before; //    
-    }
-
-    //       
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx) {
-        turns.clear(); //   
-        have_beats = false; //    
-        POS_T type = mtx[x][y]; //  
-        //   
-        switch (type) {
-        case 1: //  
-        case 2: //  
-            //      
-            for (POS_T i = x - 2; i <= x + 2; i += 4) {
-                for (POS_T j = y - 2; j <= y + 2; j += 4) {
-                    if (i < 0 || i > 7 || j < 0 || j > 7) //   
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2; //   
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2) //   
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb); //  
+        node = sp.node;
+        return sp.cutoff;
+    }
+
+    // Выполнение задачи: просмотр хода из точки разделения, если узел еще не отсечен
+    void run_task(SearchState& st, const SplitTask& task) {
+        SplitPoint& sp = *task.sp;
+        if (!split_cancelled(&sp) && !(st.root && st.root->stop.load())) {
+            const move_pos& turn = (*sp.turns)[task.index];
+            double alpha, beta;
+            {
+                lock_guard<mutex> guard(sp.lock);
+                if (update_root_alpha(st, sp.depth, sp.node.alpha)) {
+                    sp.node.alpha_orig = sp.node.alpha;
+                }
+                alpha = sp.node.alpha;
+                beta = sp.node.beta;
+                if (alpha >= beta) { // Узел уже опровергнут лучшим ходом корня: отсечение, как в update_node
+                    sp.cutoff = true;
+                    sp.cancel = true;
                 }
             }
-            break;
-        default: // 
-            //     
-            for (POS_T i = -1; i <= 1; i += 2) {
-                for (POS_T j = -1; j <= 1; j += 2) {
-                    POS_T xb = -1, yb = -1; //   
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j) {
-                        if (mtx[i2][j2]) { //   
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1)) {
-                                break; // ,        
-                            }
-                            xb = i2;
-                            yb = j2;
-                        }
-                        if (xb != -1 && xb != i2) { //   
-                            turns.emplace_back(x, y, i2, j2, xb, yb);
-                        }
+            if (alpha >= beta) { // Пустое окно дало бы в потомках неверные границы, ход не смотрим
+                --sp.pending;
+                return;
+            }
+            SplitPoint* outer = st.split;
+            st.split = &sp;
+            const Position outer_pos = st.pos; // Задача смотрится из позиции узла, свой перебор потока продолжится после
+            const EvalTerms outer_ev = st.ev;
+            st.pos = sp.pos;
+            st.ev = sp.ev;
+#if SEARCH_STATS
+            const int outer_series = st.series, outer_series_sq = st.series_sq;
+            st.series = 0; // Узлы разделяются только в начале хода
+#endif
+            const double score = search_turn(st, sp.color, sp.depth, turn, sp.have_beats, alpha, beta, false);
+            const bool aborted = search_aborted(st);
+            st.pos = outer_pos;
+            st.ev = outer_ev;
+#if SEARCH_STATS
+            st.series = outer_series;
+            st.series_sq = outer_series_sq;
+#endif
+            st.split = outer;
+            if (!aborted) {
+                lock_guard<mutex> guard(sp.lock);
+                if (!sp.cutoff && update_node(st, sp.node, sp.depth, turn, score)) {
+                    SEARCH_STAT(st.counters.cutoff(size_t(task.index)));
+                    sp.cutoff = true;
+                    sp.cancel = true; // Остальные ходы узла, в том числе уже украденные, больше не нужны
+                    if (!sp.have_beats) {
+                        update_ordering(st, turn, int(sp.depth), Max_depth - int(sp.depth));
                     }
                 }
             }
-            break;
         }
-        //   , 
-        if (!turns.empty()) {
-            have_beats = true;
+        --sp.pending; // После этого владелец может удалить точку разделения
+    }
+
+    // Кража задачи из очередей других потоков. Если задан узел sp, подходят только задачи внутри него
+    bool steal_task(const SearchState& st, const SplitPoint* sp, SplitTask& task) {
+        const size_t me = size_t(&st - states.data());
+        for (size_t k = 1; k < states.size(); ++k) {
+            SearchState& victim = states[(me + k) % states.size()];
+            const bool found = victim.queue->steal(task, [sp](const SplitTask& t) {
+                for (const SplitPoint* cur = t.sp; sp && cur != sp; cur = cur->parent) {
+                    if (!cur)
+                        return false;
+                }
+                return true;
+            });
+            if (found)
+                return true;
+        }
+        return false;
+    }
+
+    // Прерван ли перебор потока: по времени или отсечением в одной из точек разделения над ним
+    bool search_aborted(const SearchState& st) const {
+        return st.stop || (st.root && st.root->stop.load(memory_order_relaxed)) || split_cancelled(st.split);
+    }
+
+    // Отсечена ли точка разделения sp или одна из точек разделения, внутри которых она находится
+    bool split_cancelled(const SplitPoint* sp) const {
+        for (; sp; sp = sp->parent) {
+            if (sp->cancel.load(memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // Подтягивание alpha к общей границе корня в узлах сразу под корнем. Возвращает true, если alpha выросла
+    bool update_root_alpha(const SearchState& st, const size_t depth, double& alpha) const {
+        if (depth != 0 || !st.root)
+            return false;
+        const double shared = st.root->alpha.load(memory_order_relaxed);
+        if (shared <= alpha)
+            return false;
+        alpha = shared;
+        return true;
+    }
+
+    // Упорядочивание ходов: лучший ход из таблицы или прошлой итерации, затем удары по ценности
+    // побитой фигуры, ходы-убийцы глубины ply и тихие ходы по истории отсечений (только при ply >= 0).
+    // Сортировка устойчивая, поэтому перемешивание в find_turns разрешает только равные ходы.
+    void order_turns(const SearchState& st, MoveList& list, const Position& pos, const int ply,
+        const int best_from, const int best_to) const {
+        const int n = int(list.size());
+        if (n < 2)
             return;
+        int scores[MAX_MOVES];
+        for (int i = 0; i < n; ++i) {
+            const move_pos& turn = list[i];
+            const int from = cell_to_sq(turn.x, turn.y), to = cell_to_sq(turn.x2, turn.y2);
+            const POS_T type = pos.at(from);
+            const bool promotion = (type == 1 && turn.x2 == 0) || (type == 2 && turn.x2 == 7);
+            int score = 0;
+            if (from == best_from && to == best_to) {
+                score = 1 << 24; // Лучший ход прошлого поиска
+            }
+            else if (turn.xb != -1) {
+                score = (1 << 22) + (pos.at(turn.xb, turn.yb) > 2 ? 64 : 16) + promotion * 8; // Удар
+            }
+            else if (promotion) {
+                score = 1 << 21; // Превращение в дамку
+            }
+            else if (ply < 0) {
+                score = 0; // В корне порядок тихих ходов не зависит от истории потока
+            }
+            else if (ply < MAX_PLY && st.killers[ply][0] == from * 32 + to) {
+                score = (1 << 20) + 1; // Ход-убийца
+            }
+            else if (ply < MAX_PLY && st.killers[ply][1] == from * 32 + to) {
+                score = 1 << 20;
+            }
+            else {
+                score = st.history[from][to]; // Тихий ход по истории отсечений
+            }
+            scores[i] = score;
         }
-        //   
-        switch (type) {
-        case 1: //  
-        case 2: //  
-            POS_T i = ((type % 2) ? x - 1 : x + 1); //  
-            for (POS_T j = y - 1; j <= y + 1; j += 2) { //  
-                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j]) //     
-                    continue;
-                turns.emplace_back(x, y, i, j); //  
-            }
-            break;
-        default: // 
-            //     
-            for (POS_T i = -1; i <= 1; i += 2) {
-                for (POS_T j = -1; j <= 1; j += 2) {
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j) {
-                        if (mtx[i2][j2]) //   , 
-                            break;
-                        turns.emplace_back(x, y, i2, j2); //  
-                    }
+        // Устойчивая сортировка вставками по убыванию оценки
+        for (int i = 1; i < n; ++i) {
+            const move_pos turn = list[i];
+            const int score = scores[i];
+            int j = i - 1;
+            for (; j >= 0 && scores[j] < score; --j) {
+                list[j + 1] = list[j];
+                scores[j + 1] = scores[j];
+            }
+            list[j + 1] = turn;
+            scores[j + 1] = score;
+        }
+    }
+
+    // Обновление ходов-убийц и истории после отсечения тихим ходом turn
+    void update_ordering(SearchState& st, const move_pos& turn, const int ply, const int depth_left) const {
+        const int from = cell_to_sq(turn.x, turn.y), to = cell_to_sq(turn.x2, turn.y2);
+        if (ply < MAX_PLY && st.killers[ply][0] != from * 32 + to) {
+            st.killers[ply][1] = st.killers[ply][0];
+            st.killers[ply][0] = from * 32 + to;
+        }
+        st.history[from][to] += depth_left * depth_left;
+        if (st.history[from][to] >= (1 << 20)) { // Не даем истории обогнать ходов-убийц
+            for (auto& row : st.history)
+                for (auto& value : row)
+                    value /= 2;
+        }
+    }
+
+    // Сброс ходов-убийц и ослабление истории перед новым поиском
+    void clear_ordering() {
+        for (auto& st : states) {
+            for (auto& row : st.killers)
+                row[0] = row[1] = -1;
+            for (auto& row : st.history)
+                for (auto& value : row)
+                    value /= 2;
+        }
+    }
+
+public:
+    // Перегруженные функции для поиска ходов (заполняют публичные поля turns и have_beats)
+    void find_turns(const bool color, const Position& pos) {
+        MoveList list;
+        have_beats = find_turns(states[0], color, pos, list); // Ищем ходы для заданного цвета в позиции
+        turns = list.to_vector();
+    }
+
+    void find_turns(const POS_T x, const POS_T y, const Position& pos) {
+        MoveList list;
+        have_beats = find_turns(x, y, pos, list); // Ищем ходы для фигуры в заданной позиции
+        turns = list.to_vector();
+    }
+
+private:
+    // Основная функция для поиска ходов для игрока: ходы записываются в res.
+    // Возвращает true, если ходы - удары (тогда тихие ходы не допускаются)
+    bool find_turns(SearchState& st, const bool color, const Position& pos, MoveList& res) const {
+        res.clear();
+        // Перебираем только клетки с фигурами заданного цвета (по возрастанию номера клетки): сначала удары
+        for (uint32_t own = pos.pieces(color); own; own &= own - 1) {
+            add_piece_beats(lsb(own), pos, res);
+        }
+        const bool beats = !res.empty();
+        if (!beats) { // Ударов нет - тихие ходы
+            for (uint32_t own = pos.pieces(color); own; own &= own - 1) {
+                add_piece_moves(lsb(own), pos, res);
+            }
+        }
+        shuffle(res.begin(), res.end(), st.rand_eng); // Перемешиваем ходы для случайности
+        return beats;
+    }
+
+    // Функция для поиска ходов для конкретной фигуры: удары, а если их нет - тихие ходы
+    bool find_turns(const POS_T x, const POS_T y, const Position& pos, MoveList& res) const {
+        const int sq = cell_to_sq(x, y);
+        res.clear();
+        add_piece_beats(sq, pos, res);
+        if (!res.empty())
+            return true;
+        add_piece_moves(sq, pos, res);
+        return false;
+    }
+
+    // Удары фигуры на клетке sq по таблицам лучей и ударов (без проверок границ доски)
+    void add_piece_beats(const int sq, const Position& pos, MoveList& res) const {
+        const POS_T x = sq_x(sq), y = sq_y(sq); // Координаты фигуры
+        const bool color = (pos.black >> sq) & 1; // Цвет фигуры
+        const uint32_t occ = pos.occupied(); // Занятые клетки
+        const uint32_t opp = pos.pieces(!color); // Фигуры соперника
+        if (!((pos.kings >> sq) & 1)) { // Шашка бьет во всех четырех направлениях
+            // Клетка-заглушка OFF_BOARD считается занятой и не принадлежит сопернику
+            const uint64_t occ64 = occ | (uint64_t(1) << OFF_BOARD);
+            const uint64_t opp64 = opp;
+            for (int d = 0; d < 4; ++d) {
+                const int over = rays.jump_over[sq][d], to = rays.jump_to[sq][d];
+                if (((opp64 >> over) & 1) && !((occ64 >> to) & 1)) {
+                    res.emplace_back(x, y, sq_x(to), sq_y(to), sq_x(over), sq_y(over)); // Добавляем удар
+                }
+            }
+            return;
+        }
+        // Дамка: удар возможен, если первая фигура на луче - фигура соперника и за ней есть свободные клетки
+        for (int d = 0; d < 4; ++d) {
+            const uint32_t blockers = rays.ray[sq][d] & occ;
+            if (!blockers)
+                continue;
+            const int b = nearest_on_ray(blockers, d); // Ближайшая фигура на луче
+            if (!((opp >> b) & 1))
+                continue;
+            for (uint32_t land = free_ray(b, d, occ); land; land &= land - 1) {
+                const int to = lsb(land);
+                res.emplace_back(x, y, sq_x(to), sq_y(to), sq_x(b), sq_y(b)); // Добавляем удар
+            }
+        }
+    }
+
+    // Тихие ходы фигуры на клетке sq
+    void add_piece_moves(const int sq, const Position& pos, MoveList& res) const {
+        const POS_T x = sq_x(sq), y = sq_y(sq); // Координаты фигуры
+        const bool color = (pos.black >> sq) & 1; // Цвет фигуры
+        const uint32_t occ = pos.occupied(); // Занятые клетки
+        if (!((pos.kings >> sq) & 1)) { // Шашка ходит только вперед: белые вверх по доске, черные вниз
+            const uint64_t occ64 = occ | (uint64_t(1) << OFF_BOARD);
+            for (int d = (color ? 2 : 0); d < (color ? 4 : 2); ++d) {
+                const int to = rays.step[sq][d];
+                if (!((occ64 >> to) & 1)) {
+                    res.emplace_back(x, y, sq_x(to), sq_y(to)); // Добавляем ход
                 }
             }
-            break;
+            return;
+        }
+        // Тихие ходы дамки по всем свободным клеткам лучей
+        for (int d = 0; d < 4; ++d) {
+            for (uint32_t land = free_ray(sq, d, occ); land; land &= land - 1) {
+                const int to = lsb(land);
+                res.emplace_back(x, y, sq_x(to), sq_y(to)); // Добавляем ход
+            }
         }
     }
 
 public:
-    //   
+    // Публичные поля класса
 
-    vector<move_pos> turns; //   
-    bool have_beats;        //   
-    int Max_depth;          //   
+    vector<move_pos> turns; // Все найденные ходы
+    bool have_beats;        // Флаг наличия ударов
+    int Max_depth;          // Максимальная глубина поиска
 
 private:
-    //   
-
-    default_random_engine rand_eng; //   
-    string scoring_mode;           //   
-    string optimization;           //   
-    vector<move_pos> next_move;    //   
-    vector<int> next_best_state;   //   
-    Board* board;                  //    
-    Config* config;                //    
-};
\ No newline at end of file
+    // Приватные поля класса
+
+    bool no_random = false;        // Детерминированный режим бота
+    unsigned seed = 0;             // Начальное значение генераторов случайных чисел
+    Evaluator evaluator;           // Оценка позиции в режиме BotScoringType
+    string optimization;           // Уровень оптимизации алгоритма
+    bool quiescence_enabled = true; // Форсированный перебор ударов за пределом глубины (Quiescence)
+    vector<SearchState> states;    // Состояния потоков перебора (states[0] - основной поток)
+    TranspositionTable tt;         // Таблица транспозиций, сохраняется между ходами бота
+    EndgameTable endgame;          // Таблицы окончаний (не используются в O0)
+    OpeningBook book;              // Дебютная книга
+    bool bot_color = false;        // Цвет бота в текущем поиске
+    int split_depth = 0;           // Минимальная оставшаяся глубина узла для разделения между потоками (0 - только корень)
+    int time_limit_ms = 0;         // Время на ход в миллисекундах (0 - поиск на фиксированную глубину)
+    chrono::steady_clock::time_point search_deadline; // Момент, к которому поиск должен завершиться
+    bool can_stop = false;         // Можно ли прервать текущую итерацию
+    move_pos root_best = move_pos(-1, -1, -1, -1); // Лучший ход прошлой итерации в корне
+    uint64_t last_root_key = 0;    // Хэш корня прошлого завершенного поиска (для окна стремления)
+    double last_root_score = 0;    // Оценка корня прошлого завершенного поиска
+    Config* config;                // Указатель на конфигурацию игры
+    MoveStats move_stats;          // Статистика последнего хода find_best_turns
+    int root_researches = 0;       // Повторные переборы корня за текущий ход
+    unique_ptr<Ponder> ponder;     // Размышление в ходе соперника (поток останавливается первым при удалении)
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Класс MappedFile отображает файл в память только для чтения.
+// Данные читаются операционной системой по мере обращения, поэтому большие таблицы
+// (окончания, дебютная книга) не загружаются целиком и общие для всех потоков перебора.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            ptr = other.ptr;
+            len = other.len;
+#ifdef _WIN32
+            file = other.file;
+            mapping = other.mapping;
+            other.file = INVALID_HANDLE_VALUE;
+            other.mapping = nullptr;
+#endif
+            other.ptr = nullptr;
+            other.len = 0;
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    // Отображение файла path. Возвращает false, если файла нет или он пустой
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || !file_size.QuadPart) {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            close();
+            return false;
+        }
+        ptr = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        len = size_t(file_size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !st.st_size) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // Отображение остается действительным и после закрытия файла
+        if (addr == MAP_FAILED)
+            return false;
+        ptr = static_cast<const uint8_t*>(addr);
+        len = size_t(st.st_size);
+#endif
+        if (!ptr) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Снятие отображения
+    void close() {
+#ifdef _WIN32
+        if (ptr)
+            UnmapViewOfFile(ptr);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (ptr)
+            munmap(const_cast<uint8_t*>(ptr), len);
+#endif
+        ptr = nullptr;
+        len = 0;
+    }
+
+    bool is_open() const {
+        return ptr != nullptr;
+    }
+
+    const uint8_t* data() const {
+        return ptr;
+    }
+
+    size_t size() const {
+        return len;
+    }
+
+private:
+    const uint8_t* ptr = nullptr; // Начало отображенных данных
+    size_t len = 0;               // Размер файла
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE; // Открытый файл
+    HANDLE mapping = nullptr;           // Объект отображения
+#endif
+};
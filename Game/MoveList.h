@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stddef.h>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../Models/Move.h"
+
+// Наибольшее количество ходов в позиции: у игрока не больше 12 фигур, у каждой не больше 13 клеток назначения
+// (дамка на большой диагонали), а удар однозначно задается начальной и конечной клетками
+const int MAX_MOVES = 12 * 13;
+
+// Класс FixedList - список постоянной емкости N без выделения памяти в куче (живет в стеке или внутри объекта).
+// Элементы не инициализируются заранее, поэтому пустой список создается бесплатно. Только для простых типов
+template <class T, int N>
+class FixedList {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+        "FixedList stores plain types only");
+
+public:
+    FixedList() = default;
+
+    FixedList(const FixedList& other) : count(other.count) {
+        std::copy(other.begin(), other.end(), begin());
+    }
+
+    FixedList& operator=(const FixedList& other) {
+        count = other.count;
+        std::copy(other.begin(), other.end(), begin());
+        return *this;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Добавление элемента (емкости N должно хватать по построению)
+    void push_back(const T& value) {
+        new (data() + count++) T(value);
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        new (data() + count++) T(std::forward<Args>(args)...);
+    }
+
+    T& operator[](const size_t i) {
+        return data()[i];
+    }
+
+    const T& operator[](const size_t i) const {
+        return data()[i];
+    }
+
+    T& front() {
+        return data()[0];
+    }
+
+    const T& front() const {
+        return data()[0];
+    }
+
+    T& back() {
+        return data()[count - 1];
+    }
+
+    const T& back() const {
+        return data()[count - 1];
+    }
+
+    T* begin() {
+        return data();
+    }
+
+    T* end() {
+        return data() + count;
+    }
+
+    const T* begin() const {
+        return data();
+    }
+
+    const T* end() const {
+        return data() + count;
+    }
+
+    // Копия в std::vector (для кода вне перебора)
+    std::vector<T> to_vector() const {
+        return std::vector<T>(begin(), end());
+    }
+
+private:
+    T* data() {
+        return reinterpret_cast<T*>(storage);
+    }
+
+    const T* data() const {
+        return reinterpret_cast<const T*>(storage);
+    }
+
+    alignas(T) unsigned char storage[N * sizeof(T)]; // Память под элементы
+    size_t count = 0;                                // Количество элементов
+};
+
+// Ходы позиции или последовательность ходов (серия ударов короче: за ход бьется не больше 12 фигур)
+typedef FixedList<move_pos, MAX_MOVES> MoveList;
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include "../Models/Position.h"
+#include "Cpu.h"
+#include "MappedFile.h"
+
+// Сигнатура файла весов нейросети
+const char NETWORK_MAGIC[8] = { 'C', 'K', 'N', 'N', 'U', 'E', '1', '\0' };
+
+// Размеры слоев: вход - фигура каждого из 4 типов на каждой из 32 клеток, первый слой (аккумулятор)
+// обновляется ходами, второй слой и выход считаются в листе
+const int NN_INPUTS = 4 * 32;
+const int NN_HIDDEN = 32;
+const int NN_HIDDEN2 = 16;
+
+// Квантование: активации слоев - целые 0..NN_QA (1.0 = NN_QA), веса второго и выходного слоев -
+// целые с масштабом NN_QB, поэтому выход сети - целое в единицах 1 / (NN_QA * NN_QB)
+const int NN_QA = 127;
+const int NN_QB = 64;
+
+// Заголовок файла: сигнатура и размеры слоев (должны совпадать с константами выше)
+struct NetworkFileHeader {
+    char magic[8];
+    uint32_t inputs, hidden, hidden2, reserved;
+};
+
+// Веса сети в том виде, в каком они лежат в файле после заголовка (little-endian, с выравниванием)
+struct NetworkWeights {
+    alignas(32) int16_t w1[NN_INPUTS][NN_HIDDEN]; // Столбец аккумулятора для каждого входа (масштаб NN_QA)
+    alignas(32) int16_t b1[NN_HIDDEN];            // Начальное значение аккумулятора (масштаб NN_QA)
+    alignas(32) int8_t w2[NN_HIDDEN2][NN_HIDDEN]; // Второй слой (масштаб NN_QB)
+    int32_t b2[NN_HIDDEN2];                       // (масштаб NN_QA * NN_QB)
+    int16_t w3[NN_HIDDEN2];                       // Выходной слой (масштаб NN_QB)
+    int32_t b3;                                   // (масштаб NN_QA * NN_QB)
+};
+
+static_assert(sizeof(NetworkFileHeader) == 24 && sizeof(NetworkWeights) == 8896, "Network file layout");
+
+// Номер входа сети для фигуры типа type (1..4, как в Position::at) на клетке sq
+constexpr int nn_feature(const int type, const int sq) {
+    return (type - 1) * 32 + sq;
+}
+
+// Ядра сети. Аккумулятор - NN_HIDDEN целых int16, к нему прибавляется (sign = 1) или вычитается столбец
+// весов входа. Выход: clamp(acc) -> второй слой int8 -> clamp -> выходной слой. Все ядра считают
+// в одних и тех же целых числах и дают одинаковый до бита результат
+inline void nn_update_scalar(int16_t* acc, const int16_t* column, const int sign) {
+    for (int j = 0; j < NN_HIDDEN; ++j) {
+        acc[j] = int16_t(acc[j] + sign * column[j]);
+    }
+}
+
+// Второй слой после суммы с весами (z в масштабе NN_QA * NN_QB) - снова активация 0..NN_QA
+inline int32_t nn_activation(const int32_t z) {
+    return z < 0 ? 0 : std::min(z >> 6, int32_t(NN_QA)); // >> 6 - деление на NN_QB
+}
+
+inline int32_t nn_forward_scalar(const NetworkWeights& w, const int16_t* acc) {
+    uint8_t h1[NN_HIDDEN];
+    for (int j = 0; j < NN_HIDDEN; ++j) {
+        h1[j] = uint8_t(std::min(std::max(int(acc[j]), 0), NN_QA));
+    }
+    int32_t out = w.b3;
+    for (int k = 0; k < NN_HIDDEN2; ++k) {
+        int32_t z = w.b2[k];
+        for (int j = 0; j < NN_HIDDEN; ++j) {
+            z += h1[j] * w.w2[k][j];
+        }
+        out += nn_activation(z) * w.w3[k];
+    }
+    return out;
+}
+
+#ifdef EVAL_X86
+static_assert(NN_HIDDEN == 32 && NN_HIDDEN2 % 4 == 0 && NN_QB == 64, "Network kernels layout");
+
+EVAL_TARGET("sse4.1") inline void nn_update_sse41(int16_t* acc, const int16_t* column, const int sign) {
+    __m128i* a = reinterpret_cast<__m128i*>(acc);
+    const __m128i* c = reinterpret_cast<const __m128i*>(column);
+    for (int i = 0; i < NN_HIDDEN / 8; ++i) {
+        a[i] = sign > 0 ? _mm_add_epi16(a[i], c[i]) : _mm_sub_epi16(a[i], c[i]);
+    }
+}
+
+EVAL_TARGET("avx2") inline void nn_update_avx2(int16_t* acc, const int16_t* column, const int sign) {
+    __m256i* a = reinterpret_cast<__m256i*>(acc);
+    const __m256i* c = reinterpret_cast<const __m256i*>(column);
+    for (int i = 0; i < NN_HIDDEN / 16; ++i) {
+        a[i] = sign > 0 ? _mm256_add_epi16(a[i], c[i]) : _mm256_sub_epi16(a[i], c[i]);
+    }
+}
+
+// Суммы четырех векторов int32 по отдельности: результат - (sum(s0), sum(s1), sum(s2), sum(s3))
+EVAL_TARGET("sse4.1") inline __m128i nn_hsum4(const __m128i s0, const __m128i s1, const __m128i s2,
+    const __m128i s3) {
+    return _mm_hadd_epi32(_mm_hadd_epi32(s0, s1), _mm_hadd_epi32(s2, s3));
+}
+
+// Второй слой для четырех нейронов с суммами z (без смещения) и их вклад в выход
+EVAL_TARGET("sse4.1") inline __m128i nn_output4(const NetworkWeights& w, const int k, const __m128i z) {
+    __m128i h = _mm_add_epi32(z, _mm_loadu_si128(reinterpret_cast<const __m128i*>(w.b2 + k)));
+    h = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(h, 6), _mm_setzero_si128()), _mm_set1_epi32(NN_QA));
+    const __m128i w3 = _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(w.w3 + k)));
+    return _mm_mullo_epi32(h, w3);
+}
+
+EVAL_TARGET("sse4.1") inline int32_t nn_forward_sse41(const NetworkWeights& w, const int16_t* acc) {
+    const __m128i* a = reinterpret_cast<const __m128i*>(acc);
+    const __m128i qa = _mm_set1_epi8(NN_QA), ones = _mm_set1_epi16(1);
+    // Активации первого слоя: насыщение до 0..255 при упаковке в байты, затем не больше NN_QA
+    const __m128i h_lo = _mm_min_epu8(_mm_packus_epi16(a[0], a[1]), qa);
+    const __m128i h_hi = _mm_min_epu8(_mm_packus_epi16(a[2], a[3]), qa);
+    __m128i out = _mm_setzero_si128();
+    for (int k = 0; k < NN_HIDDEN2; k += 4) {
+        __m128i s[4];
+        for (int r = 0; r < 4; ++r) {
+            const __m128i* row = reinterpret_cast<const __m128i*>(w.w2[k + r]);
+            // Произведения байтов попарно в int16 (не больше 2 * 127 * 128 - без насыщения). Сумма двух таких
+            // пар в int16 уже переполняется, поэтому каждая половина сначала расширяется до int32
+            s[r] = _mm_add_epi32(_mm_madd_epi16(_mm_maddubs_epi16(h_lo, row[0]), ones),
+                _mm_madd_epi16(_mm_maddubs_epi16(h_hi, row[1]), ones));
+        }
+        out = _mm_add_epi32(out, nn_output4(w, k, nn_hsum4(s[0], s[1], s[2], s[3])));
+    }
+    out = _mm_hadd_epi32(out, out);
+    return w.b3 + _mm_cvtsi128_si32(_mm_hadd_epi32(out, out));
+}
+
+EVAL_TARGET("avx2") inline int32_t nn_forward_avx2(const NetworkWeights& w, const int16_t* acc) {
+    const __m256i* a = reinterpret_cast<const __m256i*>(acc);
+    // Упаковка переставляет 64-битные части (a0 a1 a0 a1), перестановка возвращает порядок нейронов
+    __m256i h = _mm256_min_epu8(_mm256_packus_epi16(a[0], a[1]), _mm256_set1_epi8(NN_QA));
+    h = _mm256_permute4x64_epi64(h, 0xD8);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m128i out = _mm_setzero_si128();
+    for (int k = 0; k < NN_HIDDEN2; k += 4) {
+        __m128i s[4];
+        for (int r = 0; r < 4; ++r) {
+            const __m256i p = _mm256_madd_epi16(
+                _mm256_maddubs_epi16(h, *reinterpret_cast<const __m256i*>(w.w2[k + r])), ones);
+            s[r] = _mm_add_epi32(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+        }
+        out = _mm_add_epi32(out, nn_output4(w, k, nn_hsum4(s[0], s[1], s[2], s[3])));
+    }
+    out = _mm_hadd_epi32(out, out);
+    return w.b3 + _mm_cvtsi128_si32(_mm_hadd_epi32(out, out));
+}
+#endif
+
+// Класс Network - небольшая квантованная нейросеть оценки (в духе NNUE), веса строит Tools/nnue_train.cpp.
+// Первый слой линеен по фигурам, поэтому его выход (аккумулятор) хранится в слагаемых оценки и обновляется
+// ходом: снятие или постановка фигуры - одно сложение столбца весов. В листе считаются только второй
+// слой и выход. Файл небольшой и читается в память целиком.
+class Network {
+public:
+    // Загрузка весов из файла path. Возвращает false, если файла нет или он поврежден
+    bool open(const std::string& path) {
+        weights.reset();
+        MappedFile file;
+        if (!file.open(path))
+            return false;
+        NetworkFileHeader header;
+        if (file.size() != sizeof(header) + sizeof(NetworkWeights))
+            return false;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, NETWORK_MAGIC, sizeof(header.magic)) != 0 || header.inputs != NN_INPUTS ||
+            header.hidden != NN_HIDDEN || header.hidden2 != NN_HIDDEN2)
+            return false;
+        weights = std::make_unique<NetworkWeights>();
+        std::memcpy(weights.get(), file.data() + sizeof(header), sizeof(NetworkWeights));
+        return true;
+    }
+
+    // Загружены ли веса
+    bool enabled() const {
+        return weights != nullptr;
+    }
+
+    // Аккумулятор пустой доски
+    void reset(int16_t* acc) const {
+        std::memcpy(acc, weights->b1, sizeof(weights->b1));
+    }
+
+    // Постановка (sign = 1) или снятие (sign = -1) фигуры типа type на клетке sq
+    void update(int16_t* acc, const int type, const int sq, const int sign, const EvalKernel kernel) const {
+        const int16_t* column = weights->w1[nn_feature(type, sq)];
+        switch (kernel) {
+#ifdef EVAL_X86
+        case EvalKernel::AVX2:
+            nn_update_avx2(acc, column, sign);
+            break;
+        case EvalKernel::SSE41:
+            nn_update_sse41(acc, column, sign);
+            break;
+#endif
+        default:
+            nn_update_scalar(acc, column, sign);
+        }
+    }
+
+    // Выход сети для аккумулятора acc в единицах 1 / (NN_QA * NN_QB): оценка логарифма отношения
+    // материала белых к материалу черных (в тех же единицах, что и эвристические BotScoringType)
+    int32_t forward(const int16_t* acc, const EvalKernel kernel) const {
+        switch (kernel) {
+#ifdef EVAL_X86
+        case EvalKernel::AVX2:
+            return nn_forward_avx2(*weights, acc);
+        case EvalKernel::SSE41:
+            return nn_forward_sse41(*weights, acc);
+#endif
+        default:
+            return nn_forward_scalar(*weights, acc);
+        }
+    }
+
+private:
+    std::unique_ptr<NetworkWeights> weights; // Веса (nullptr - сеть не загружена)
+};
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <cctype>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Record.h"
+
+// Партии в PDN (Portable Draughts Notation) для обмена с другими программами: русские шашки (GameType 25),
+// клетки в алгебраической записи (a1 - левый нижний угол со стороны белых), ход "c3-d4", серия ударов "c3:e5:c7".
+
+// Клетка sq в алгебраической записи
+inline std::string pdn_square(const int sq) {
+    return { char('a' + sq_y(sq)), char('8' - sq_x(sq)) };
+}
+
+// Номер клетки по алгебраической записи. Возвращает -1, если это не игровая клетка
+inline int pdn_parse_square(const std::string& str) {
+    if (str.size() != 2 || str[0] < 'a' || str[0] > 'h' || str[1] < '1' || str[1] > '8')
+        return -1;
+    const POS_T x = POS_T('8' - str[1]), y = POS_T(str[0] - 'a');
+    return (x + y) % 2 ? cell_to_sq(x, y) : -1;
+}
+
+// Результат партии в записи PDN
+inline const char* pdn_result(const GameResult result) {
+    switch (result) {
+    case GameResult::WHITE_WINS:
+        return "1-0";
+    case GameResult::BLACK_WINS:
+        return "0-1";
+    case GameResult::DRAW:
+        return "1/2-1/2";
+    default:
+        return "*";
+    }
+}
+
+// Разбор результата партии. Возвращает false, если str - не результат
+inline bool pdn_parse_result(const std::string& str, GameResult& result) {
+    if (str == "1-0" || str == "2-0")
+        result = GameResult::WHITE_WINS;
+    else if (str == "0-1" || str == "0-2")
+        result = GameResult::BLACK_WINS;
+    else if (str == "1/2-1/2" || str == "1-1")
+        result = GameResult::DRAW;
+    else if (str == "*")
+        result = GameResult::UNKNOWN;
+    else
+        return false;
+    return true;
+}
+
+// Позиция в записи FEN тега PDN: очередь хода и фигуры каждого цвета ("W:Wc3,Kd4:Bf6", K - дамка)
+inline std::string pdn_fen(const Position& pos, const bool color) {
+    std::string res(color ? "B" : "W");
+    for (int side = 0; side < 2; ++side) {
+        res += side ? ":B" : ":W";
+        bool first = true;
+        for (int sq = 0; sq < 32; ++sq) {
+            const POS_T type = pos.at(sq);
+            if (!type || (type % 2) == side) // Нечетный тип - белые фигуры
+                continue;
+            if (!first)
+                res += ',';
+            first = false;
+            res += (type > 2 ? "K" : "") + pdn_square(sq);
+        }
+    }
+    return res;
+}
+
+// Разбор записи FEN. Возвращает false, если запись не разобрана (номера клеток вместо алгебраической записи не поддерживаются)
+inline bool pdn_parse_fen(const std::string& fen, Position& pos, bool& color) {
+    pos = Position();
+    std::vector<std::string> parts(1);
+    for (const char c : fen) {
+        if (c == ':')
+            parts.emplace_back();
+        else if (c != ' ' && c != '.')
+            parts.back() += c;
+    }
+    if (parts[0] != "W" && parts[0] != "B")
+        return false;
+    color = parts[0] == "B";
+    for (size_t i = 1; i < parts.size(); ++i) {
+        if (parts[i].empty() || (parts[i][0] != 'W' && parts[i][0] != 'B'))
+            return false;
+        const POS_T black = parts[i][0] == 'B';
+        std::string item;
+        for (size_t j = 1; j <= parts[i].size(); ++j) {
+            if (j < parts[i].size() && parts[i][j] != ',') {
+                item += parts[i][j];
+                continue;
+            }
+            if (item.empty())
+                continue;
+            const bool king = item[0] == 'K';
+            const int sq = pdn_parse_square(king ? item.substr(1) : item);
+            if (sq < 0)
+                return false;
+            pos.set(sq, POS_T(1 + black + (king ? 2 : 0)));
+            item.clear();
+        }
+    }
+    return true;
+}
+
+// Запись партии в PDN: теги и ходы с номерами, строки не длиннее 80 символов.
+// Возвращает false, если запись партии повреждена
+inline bool write_pdn(std::ostream& out, const GameView& game, const std::string& event) {
+    std::vector<std::string> tokens;
+    int number = 1; // Номер хода (пара ходов белых и черных)
+    bool ok = replay_game(game, [&](const Position&, const move_pos& step, const bool color, const bool chain) {
+        if (chain) {
+            tokens.back() += ':' + pdn_square(cell_to_sq(step.x2, step.y2));
+            return;
+        }
+        std::string token; // Номер хода переносится на новую строку вместе с ходом
+        if (!color)
+            token = std::to_string(number) + ". ";
+        else if (tokens.empty())
+            token = std::to_string(number) + "... ";
+        number += color;
+        tokens.push_back(token + pdn_square(cell_to_sq(step.x, step.y)) + (step.xb != -1 ? ':' : '-') +
+            pdn_square(cell_to_sq(step.x2, step.y2)));
+    });
+    if (!ok)
+        return false;
+    tokens.push_back(pdn_result(game.result));
+
+    out << "[Event \"" << event << "\"]\n";
+    out << "[Result \"" << pdn_result(game.result) << "\"]\n";
+    out << "[GameType \"25\"]\n";
+    if (game.start != initial_position() || game.color)
+        out << "[FEN \"" << pdn_fen(game.start, game.color) << "\"]\n";
+    size_t width = 0;
+    for (const auto& token : tokens) {
+        if (width && width + 1 + token.size() > 80) {
+            out << '\n';
+            width = 0;
+        }
+        out << (width ? " " : "") << token;
+        width += (width ? 1 : 0) + token.size();
+    }
+    out << "\n\n";
+    return bool(out);
+}
+
+// Класс PdnReader - чтение партий из PDN по одной, поэтому размер файла не ограничен памятью.
+// Ходы проверяются воспроизведением: начальная клетка должна быть занята фигурой ходящего, шаг - идти
+// по диагонали на пустую клетку через не более чем одну фигуру соперника. Комментарии и варианты пропускаются.
+class PdnReader {
+public:
+    explicit PdnReader(std::istream& in) : in(in) {
+    }
+
+    // Следующая партия. Возвращает false в конце файла. Если партия не разобрана, error описывает причину
+    bool next(GameRecord& game, std::string& error) {
+        game.reset();
+        error.clear();
+        Position pos = game.start;
+        bool color = game.start_color;
+        bool any = false, moves = false;
+        for (int c = skip_space(); c != EOF; c = skip_space()) {
+            if (c == '[') {
+                if (moves) // Следующая партия без результата в конце ходов
+                    break;
+                std::string name, value;
+                read_tag(name, value);
+                any = true;
+                if (name == "FEN" && error.empty()) {
+                    if (pdn_parse_fen(value, pos, color)) {
+                        const GameResult result = game.result; // Тег Result мог быть раньше FEN
+                        game.reset(pos, color);
+                        game.result = result;
+                    }
+                    else
+                        fail(error, "unsupported FEN \"" + value + "\"");
+                }
+                if (name == "Result")
+                    pdn_parse_result(value, game.result);
+                continue;
+            }
+            if (c == '{' || c == '(' || c == ';') {
+                skip_comment();
+                continue;
+            }
+            const std::string token = read_token();
+            any = true;
+            GameResult result;
+            if (pdn_parse_result(token, result)) {
+                game.result = result;
+                break;
+            }
+            moves = true;
+            if (error.empty())
+                play(token, pos, color, game, error);
+        }
+        return any;
+    }
+
+    // Номер текущей строки файла (для сообщений об ошибках)
+    int line() const {
+        return line_number;
+    }
+
+private:
+    // Ход token (с номером хода или без): клетки через '-', ':' или 'x'
+    void play(const std::string& token, Position& pos, bool& color, GameRecord& game, std::string& error) {
+        size_t begin = 0;
+        while (begin < token.size() && isdigit((unsigned char)token[begin]))
+            ++begin;
+        if (begin < token.size() && token[begin] == '.') { // Номер хода "12." или "12..."
+            while (begin < token.size() && token[begin] == '.')
+                ++begin;
+        }
+        else {
+            begin = 0;
+        }
+        size_t end = token.size();
+        while (end > begin && (token[end - 1] == '!' || token[end - 1] == '?' || token[end - 1] == '+'))
+            --end;
+        if (begin == end)
+            return;
+        std::vector<int> squares;
+        std::string square;
+        for (size_t i = begin; i <= end; ++i) {
+            if (i < end && token[i] != '-' && token[i] != ':' && token[i] != 'x') {
+                square += token[i];
+                continue;
+            }
+            squares.push_back(pdn_parse_square(square));
+            if (squares.back() < 0)
+                return fail(error, "bad square in move " + token);
+            square.clear();
+        }
+        if (squares.size() < 2 || !(pos.pieces(color) & (uint32_t(1) << squares[0])))
+            return fail(error, "illegal move " + token);
+        for (size_t i = 1; i < squares.size(); ++i) {
+            move_pos step(0, 0, 0, 0);
+            if (!make_step(pos, squares[i - 1], squares[i], step))
+                return fail(error, "illegal move " + token);
+            game.add_step(step, i > 1);
+            pos = pos.make_turn(step);
+        }
+        color = !color;
+    }
+
+    void fail(std::string& error, const std::string& text) const {
+        error = "line " + std::to_string(line_number) + ": " + text;
+    }
+
+    int get() {
+        const int c = in.get();
+        if (c == '\n')
+            ++line_number;
+        return c;
+    }
+
+    // Пропуск пробелов. Возвращает следующий символ, не забирая его из потока
+    int skip_space() {
+        while (isspace(in.peek()))
+            get();
+        return in.peek();
+    }
+
+    // Тег "[Name "Value"]"
+    void read_tag(std::string& name, std::string& value) {
+        get();
+        int c;
+        while ((c = get()) != EOF && !isspace(c) && c != '"' && c != ']')
+            name += char(c);
+        while (c != EOF && c != '"' && c != ']')
+            c = get();
+        if (c == '"') {
+            while ((c = get()) != EOF && c != '"') {
+                if (c == '\\')
+                    c = get();
+                value += char(c);
+            }
+        }
+        while (c != EOF && c != ']')
+            c = get();
+    }
+
+    // Комментарий {...}, вариант (...) с вложенными вариантами или комментарий ";" до конца строки
+    void skip_comment() {
+        const int open = get();
+        if (open == ';') {
+            for (int c = get(); c != EOF && c != '\n'; c = get()) {
+            }
+            return;
+        }
+        int depth = 1;
+        for (int c = get(); c != EOF && depth; c = get()) {
+            if (open == '(' && c == '{') {
+                for (c = get(); c != EOF && c != '}'; c = get()) {
+                }
+            }
+            else if (c == open) {
+                ++depth;
+            }
+            else if (c == (open == '(' ? ')' : '}')) {
+                if (!--depth)
+                    return;
+            }
+        }
+    }
+
+    std::string read_token() {
+        std::string res;
+        for (int c = in.peek(); c != EOF && !isspace(c) && c != '[' && c != '{' && c != '(' && c != ';'; c = in.peek())
+            res += char(get());
+        return res;
+    }
+
+    std::istream& in;
+    int line_number = 1;
+};
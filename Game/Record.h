@@ -0,0 +1,374 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+// Архив партий: заголовок файла, записи партий подряд и в конце - индекс смещений записей (партия по номеру
+// читается без прохода по файлу). Ход партии со всеми шагами серии ударов занимает 1 + количество шагов байт:
+// байт начальной клетки (старший бит 0) и байт клетки после каждого шага (старший бит 1), поэтому простой ход -
+// 2 байта. Побитая фигура не пишется: это единственная фигура на диагонали шага, она находится при воспроизведении.
+
+// Сигнатура файла архива
+const char GAMES_MAGIC[8] = { 'C', 'K', 'G', 'A', 'M', 'E', 'S', '1' };
+
+// Заголовок файла: сигнатура и смещение индекса (0 - архив не был закрыт, индекс восстанавливается чтением записей)
+struct GamesFileHeader {
+    char magic[8];
+    uint64_t index_offset;
+};
+
+// Заголовок записи партии, за ним - начальная позиция (если есть флаг GAME_START_POSITION) и байты ходов
+struct GameRecordHeader {
+    uint32_t size;  // Количество байт ходов
+    uint16_t plies; // Количество ходов (полуходов)
+    uint8_t result; // GameResult
+    uint8_t flags;
+};
+
+// Начальная позиция партии, если она отличается от обычной или первыми ходят черные
+struct GameStart {
+    uint32_t white, black, kings;
+    uint8_t color; // Очередь хода (0 - белые, 1 - черные)
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(GamesFileHeader) == 16 && sizeof(GameRecordHeader) == 8 && sizeof(GameStart) == 16,
+    "Games file layout");
+
+const uint8_t GAME_START_POSITION = 1; // Флаг записи: за заголовком записана GameStart
+const uint8_t GAME_STEP = 0x80;        // Старший бит байта хода: клетка после шага, а не начальная клетка хода
+
+// Результат партии
+enum class GameResult : uint8_t {
+    UNKNOWN = 0, // Партия не доиграна
+    WHITE_WINS = 1,
+    BLACK_WINS = 2,
+    DRAW = 3
+};
+
+// Начальная позиция обычной партии
+inline Position initial_position() {
+    return Position(std::string("bbbbbbbbbbbb........wwwwwwwwwwww"));
+}
+
+// Шаг с клетки from на клетку to в позиции pos: побитая фигура - единственная фигура на диагонали между клетками.
+// Проверяется только расположение фигур, а не правила. Возвращает false, если клетки не на одной диагонали,
+// начальная клетка пуста, конечная занята или между ними своя фигура или больше одной фигуры
+inline bool make_step(const Position& pos, const int from, const int to, move_pos& step) {
+    const POS_T x = sq_x(from), y = sq_y(from), x2 = sq_x(to), y2 = sq_y(to);
+    const POS_T type = pos.at(from);
+    if (!type || pos.at(to) || x == x2 || std::abs(x2 - x) != std::abs(y2 - y))
+        return false;
+    const POS_T dx = x2 > x ? 1 : -1, dy = y2 > y ? 1 : -1;
+    step = move_pos(x, y, x2, y2);
+    for (POS_T i = x + dx, j = y + dy; i != x2; i += dx, j += dy) {
+        const POS_T other = pos.at(i, j);
+        if (!other)
+            continue;
+        if (step.xb != -1 || other % 2 == type % 2)
+            return false;
+        step.xb = i;
+        step.yb = j;
+    }
+    return true;
+}
+
+// Партия из архива или из памяти: результат, начальная позиция и байты ходов (данные не копируются)
+struct GameView {
+    GameResult result = GameResult::UNKNOWN;
+    uint16_t plies = 0;
+    Position start = initial_position();
+    bool color = 0; // Очередь хода в начальной позиции
+    const uint8_t* moves = nullptr;
+    size_t size = 0;
+};
+
+// Воспроизведение партии: f(pos, step, color, chain) для каждого шага, где pos - позиция до шага, color - цвет
+// ходящего, chain - шаг продолжает серию ударов того же хода. Возвращает false, если запись повреждена
+template <typename F>
+bool replay_game(const GameView& game, F&& f) {
+    Position pos = game.start;
+    bool color = !game.color;
+    int sq = -1;          // Клетка ходящей фигуры
+    bool pending = false; // Начальная клетка хода прочитана, шагов еще не было
+    for (size_t i = 0; i < game.size; ++i) {
+        const uint8_t byte = game.moves[i];
+        if (byte & 0x60)
+            return false;
+        if (!(byte & GAME_STEP)) { // Начало следующего хода
+            if (pending)
+                return false;
+            sq = byte;
+            color = !color;
+            pending = true;
+            continue;
+        }
+        move_pos step(0, 0, 0, 0);
+        const int to = byte & 31;
+        if (sq < 0 || !(pos.pieces(color) & (uint32_t(1) << sq)) || !make_step(pos, sq, to, step))
+            return false;
+        f(pos, step, color, !pending);
+        pos = pos.make_turn(step);
+        sq = to;
+        pending = false;
+    }
+    return !pending;
+}
+
+// Класс GameRecord - запись партии в памяти, дополняется по одному шагу по мере игры
+class GameRecord {
+public:
+    // Новая партия из позиции pos (color - кто ходит первым)
+    void reset(const Position& pos = initial_position(), const bool color = 0) {
+        start = pos;
+        start_color = color;
+        result = GameResult::UNKNOWN;
+        plies = 0;
+        moves.clear();
+    }
+
+    // Шаг хода: chain - шаг продолжает серию ударов предыдущего шага
+    void add_step(const move_pos& step, const bool chain) {
+        if (!chain || moves.empty()) {
+            moves.push_back(uint8_t(cell_to_sq(step.x, step.y)));
+            ++plies;
+        }
+        moves.push_back(uint8_t(GAME_STEP | cell_to_sq(step.x2, step.y2)));
+    }
+
+    // Отмена последнего шага (откат хода на доске)
+    void pop_step() {
+        if (moves.empty())
+            return;
+        moves.pop_back();
+        if (!moves.empty() && !(moves.back() & GAME_STEP)) {
+            moves.pop_back();
+            --plies;
+        }
+    }
+
+    GameView view() const {
+        GameView res;
+        res.result = result;
+        res.plies = plies;
+        res.start = start;
+        res.color = start_color;
+        res.moves = moves.data();
+        res.size = moves.size();
+        return res;
+    }
+
+    Position start = initial_position();
+    bool start_color = 0;
+    GameResult result = GameResult::UNKNOWN;
+    uint16_t plies = 0;
+    std::vector<uint8_t> moves; // Байты ходов в формате архива
+};
+
+// Класс GameReader - архив партий, отображенный в память только для чтения: партии читаются по номеру
+// или подряд без загрузки файла, поэтому архив может содержать десятки миллионов партий
+class GameReader {
+public:
+    // Открытие архива. Возвращает false, если файла нет или это не архив партий
+    bool open(const std::string& path) {
+        count = 0;
+        index = nullptr;
+        scanned.clear();
+        if (!file.open(path))
+            return false;
+        GamesFileHeader header;
+        if (file.size() < sizeof(header)) {
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, GAMES_MAGIC, sizeof(header.magic)) != 0) {
+            file.close();
+            return false;
+        }
+        if (header.index_offset >= sizeof(header) && header.index_offset <= file.size() &&
+            (file.size() - header.index_offset) % sizeof(uint64_t) == 0) {
+            index = file.data() + header.index_offset;
+            count = size_t((file.size() - header.index_offset) / sizeof(uint64_t));
+            end = header.index_offset;
+            return true;
+        }
+        // Архив не был закрыт: индекс строится проходом по записям до первой неполной
+        end = sizeof(header);
+        GameView game;
+        for (uint64_t next; parse(end, game, next); end = next) {
+            scanned.push_back(end);
+        }
+        count = scanned.size();
+        return true;
+    }
+
+    // Количество партий
+    size_t size() const {
+        return count;
+    }
+
+    // Партия с номером i. Возвращает false, если запись повреждена
+    bool game(const size_t i, GameView& res) const {
+        uint64_t next;
+        return i < count && parse(offset(i), res, next);
+    }
+
+    // Смещение записи партии i в файле
+    uint64_t offset(const size_t i) const {
+        if (!index)
+            return scanned[i];
+        uint64_t res;
+        std::memcpy(&res, index + i * sizeof(uint64_t), sizeof(res));
+        return res;
+    }
+
+    // Конец последней записи (начало индекса)
+    uint64_t data_end() const {
+        return end;
+    }
+
+    void close() {
+        file.close();
+        count = 0;
+        index = nullptr;
+        scanned.clear();
+    }
+
+private:
+    // Разбор записи со смещением pos, next - смещение следующей записи
+    bool parse(const uint64_t pos, GameView& res, uint64_t& next) const {
+        const uint64_t limit = index ? end : file.size();
+        GameRecordHeader header;
+        if (pos < sizeof(GamesFileHeader) || pos + sizeof(header) > limit)
+            return false;
+        std::memcpy(&header, file.data() + pos, sizeof(header));
+        next = pos + sizeof(header) + header.size;
+        GameStart start{};
+        if (header.flags & GAME_START_POSITION) {
+            if (next + sizeof(start) > limit)
+                return false;
+            std::memcpy(&start, file.data() + pos + sizeof(header), sizeof(start));
+            next += sizeof(start);
+            res.start.white = start.white;
+            res.start.black = start.black;
+            res.start.kings = start.kings;
+            res.color = start.color != 0;
+        }
+        else {
+            res.start = initial_position();
+            res.color = 0;
+        }
+        if (next > limit)
+            return false;
+        res.result = GameResult(header.result);
+        res.plies = header.plies;
+        res.moves = file.data() + next - header.size;
+        res.size = header.size;
+        return true;
+    }
+
+    MappedFile file;
+    size_t count = 0;
+    const uint8_t* index = nullptr; // Индекс в файле (nullptr - индекс построен чтением записей)
+    std::vector<uint64_t> scanned;  // Смещения записей архива, который не был закрыт
+    uint64_t end = 0;
+};
+
+// Класс GameWriter - дописывание партий в архив по мере их окончания. Записи сразу уходят в буферизованный
+// поток, индекс пишется при закрытии. Если программа завершилась, не закрыв архив, записанные партии
+// не теряются: чтение и следующее открытие восстанавливают индекс по записям.
+class GameWriter {
+public:
+    ~GameWriter() {
+        close();
+    }
+
+    // Открытие архива path для дописывания (если файла нет - создается новый).
+    // Возвращает false, если файл не удалось открыть или это не архив партий
+    bool open(const std::string& path) {
+        close();
+        offsets.clear();
+        end = sizeof(GamesFileHeader);
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec)) {
+            GameReader reader;
+            if (!reader.open(path))
+                return false; // Чужой файл не перезаписывается
+            for (size_t i = 0; i < reader.size(); ++i) {
+                offsets.push_back(reader.offset(i));
+            }
+            end = reader.data_end();
+            reader.close();
+            std::filesystem::resize_file(path, end, ec); // Старый индекс или неполная запись отбрасываются
+            if (ec)
+                return false;
+        }
+        else {
+            std::ofstream(path, std::ios::binary | std::ios::trunc);
+        }
+        fout.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        GamesFileHeader header{};
+        std::memcpy(header.magic, GAMES_MAGIC, sizeof(header.magic));
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header)); // index_offset = 0 до закрытия
+        fout.seekp(std::streamoff(end));
+        return bool(fout);
+    }
+
+    bool is_open() const {
+        return fout.is_open();
+    }
+
+    // Запись партии в конец архива
+    bool write(const GameRecord& game) {
+        GameRecordHeader header{ uint32_t(game.moves.size()), game.plies, uint8_t(game.result), 0 };
+        const bool custom = game.start != initial_position() || game.start_color;
+        if (custom)
+            header.flags |= GAME_START_POSITION;
+        offsets.push_back(end);
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        end += sizeof(header);
+        if (custom) {
+            const GameStart start{ game.start.white, game.start.black, game.start.kings, uint8_t(game.start_color), {} };
+            fout.write(reinterpret_cast<const char*>(&start), sizeof(start));
+            end += sizeof(start);
+        }
+        fout.write(reinterpret_cast<const char*>(game.moves.data()), std::streamsize(game.moves.size()));
+        end += game.moves.size();
+        return bool(fout);
+    }
+
+    // Сброс буфера в файл (после каждой партии в игре, чтобы её не потерять при аварийном завершении)
+    void flush() {
+        fout.flush();
+    }
+
+    // Запись индекса и закрытие архива. Возвращает false при ошибке записи
+    bool close() {
+        if (!fout.is_open())
+            return true;
+        fout.write(reinterpret_cast<const char*>(offsets.data()), std::streamsize(offsets.size() * sizeof(uint64_t)));
+        fout.seekp(offsetof(GamesFileHeader, index_offset));
+        fout.write(reinterpret_cast<const char*>(&end), sizeof(end));
+        fout.close();
+        return !fout.fail();
+    }
+
+    // Количество партий в архиве
+    size_t size() const {
+        return offsets.size();
+    }
+
+private:
+    std::fstream fout;
+    std::vector<uint64_t> offsets; // Смещения записей для индекса
+    uint64_t end = 0;              // Конец последней записи
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stddef.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <nlohmann/json.hpp>
+
+// Статистика перебора. Счетчики у каждого потока свои (без атомарных операций и общих строк кэша), складываются
+// только в конце хода. Сборка с -DSEARCH_STATS=0 убирает их из перебора полностью: остаются только узлы и время,
+// которые считаются всегда.
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 1
+#endif
+
+#if SEARCH_STATS
+#define SEARCH_STAT(expr) (expr)
+#else
+#define SEARCH_STAT(expr) ((void)0)
+#endif
+
+// Количество глубин, по которым считается ветвление (более глубокие узлы учитываются в последней)
+const int STATS_DEPTHS = 32;
+// Количество номеров хода в гистограмме отсечений (последний элемент - ходы с этим номером и дальше)
+const int STATS_CUTOFF_SLOTS = 8;
+
+// Счетчики одного потока перебора
+struct SearchCounters {
+    size_t evals = 0;                          // Статические оценки листьев (вместе с оценками пакетами)
+    size_t tt_cutoffs = 0;                     // Узлы, оценка которых взята из таблицы транспозиций
+    size_t endgame_hits = 0;                   // Узлы, оценка которых взята из таблиц окончаний
+    size_t cutoffs[STATS_CUTOFF_SLOTS] = {};   // Отсечения по номеру хода, вызвавшего отсечение
+    size_t expanded[STATS_DEPTHS] = {};        // Узлы, ходы которых перебирались, по глубине (0 - после хода из корня)
+    size_t moves[STATS_DEPTHS] = {};           // Количество ходов этих узлов по глубине
+    int max_series = 0;                        // Самая длинная серия ударов в переборе (в шагах)
+
+    // Отсечение ходом с номером index
+    void cutoff(const size_t index) {
+        ++cutoffs[std::min(index, size_t(STATS_CUTOFF_SLOTS - 1))];
+    }
+
+    // Узел глубины depth с n ходами
+    void expand(const size_t depth, const size_t n) {
+        const size_t d = std::min(depth, size_t(STATS_DEPTHS - 1));
+        ++expanded[d];
+        moves[d] += n;
+    }
+
+    void add(const SearchCounters& other) {
+        evals += other.evals;
+        tt_cutoffs += other.tt_cutoffs;
+        endgame_hits += other.endgame_hits;
+        for (int i = 0; i < STATS_CUTOFF_SLOTS; ++i) {
+            cutoffs[i] += other.cutoffs[i];
+        }
+        for (int d = 0; d < STATS_DEPTHS; ++d) {
+            expanded[d] += other.expanded[d];
+            moves[d] += other.moves[d];
+        }
+        max_series = std::max(max_series, other.max_series);
+    }
+};
+
+// Статистика одного хода бота: откуда взят ход, узлы, время по этапам и счетчики всех потоков
+struct MoveStats {
+    std::string source = "search"; // "search" - перебор, "book" - дебютная книга, "ponder" - ответ из размышления
+    bool color = false;            // Цвет бота
+    int depth = 0;                 // Глубина последней завершенной итерации
+    double score = 0;              // Оценка корня со стороны бота (отношение материала, INF - победа)
+    int threads = 1;
+    size_t nodes = 0, qnodes = 0, stand_pats = 0;
+    int researches = 0;            // Повторные переборы корня после выхода оценки за окно стремления
+    double book_ms = 0;            // Поиск в дебютной книге
+    double search_ms = 0;          // Перебор (все итерации)
+    double total_ms = 0;           // Весь ход
+    double iteration_ms[STATS_DEPTHS] = {}; // Время итерации углубления по глубине
+    SearchCounters counters;
+
+    // Одна строка JSON для журнала: массивы по глубине обрезаны по последней непустой глубине
+    nlohmann::json to_json() const {
+        nlohmann::json res;
+        res["source"] = source;
+        res["color"] = int(color);
+        res["depth"] = depth;
+        res["score"] = score;
+        res["threads"] = threads;
+        res["time_ms"] = round3(total_ms);
+        res["book_ms"] = round3(book_ms);
+        res["search_ms"] = round3(search_ms);
+        res["iteration_ms"] = nlohmann::json::array(); // Вместе с итерацией, прерванной по времени
+        int last_iteration = STATS_DEPTHS - 1;
+        while (last_iteration >= 0 && iteration_ms[last_iteration] <= 0)
+            --last_iteration;
+        for (int d = 0; d <= last_iteration; ++d) {
+            res["iteration_ms"].push_back(round3(iteration_ms[d]));
+        }
+        res["researches"] = researches;
+        res["nodes"] = nodes;
+        res["qnodes"] = qnodes;
+        res["stand_pats"] = stand_pats;
+        res["nps"] = search_ms > 0 ? size_t(nodes / search_ms * 1000) : 0;
+#if SEARCH_STATS
+        res["evals"] = counters.evals;
+        res["tt_cutoffs"] = counters.tt_cutoffs;
+        res["endgame_hits"] = counters.endgame_hits;
+        size_t total = 0;
+        for (const size_t n : counters.cutoffs) {
+            total += n;
+        }
+        res["cutoffs"] = counters.cutoffs;
+        res["first_cutoff"] = total ? round3(double(counters.cutoffs[0]) / total) : 0.0; // Доля отсечений первым ходом
+        int last = STATS_DEPTHS - 1;
+        while (last >= 0 && !counters.expanded[last])
+            --last;
+        res["depth_nodes"] = nlohmann::json::array();
+        res["branching"] = nlohmann::json::array(); // Среднее количество ходов в узле глубины
+        for (int d = 0; d <= last; ++d) {
+            res["depth_nodes"].push_back(counters.expanded[d]);
+            res["branching"].push_back(counters.expanded[d] ?
+                round3(double(counters.moves[d]) / counters.expanded[d]) : 0.0);
+        }
+        res["max_series"] = counters.max_series;
+#endif
+        return res;
+    }
+
+private:
+    static double round3(const double value) {
+        return std::round(value * 1000) / 1000;
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+
+// Ключи Зобриста для позиций: по ключу на каждый тип фигуры (1..4) на каждой из 32 клеток
+struct ZobristKeys {
+    uint64_t piece[32][5]; // Ключи фигур (индекс 0 не используется)
+    uint64_t black_move;   // Ключ очереди хода черных
+    uint64_t black_bot;    // Ключ стороны, за которую считается оценка (черный бот)
+
+    constexpr ZobristKeys() : piece(), black_move(0), black_bot(0) {
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        for (int sq = 0; sq < 32; ++sq) {
+            for (int type = 1; type < 5; ++type) {
+                piece[sq][type] = next(seed);
+            }
+        }
+        black_move = next(seed);
+        black_bot = next(seed);
+    }
+
+private:
+    // Генератор splitmix64 для заполнения таблицы на этапе компиляции
+    static constexpr uint64_t next(uint64_t& seed) {
+        seed += 0x9E3779B97F4A7C15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+constexpr ZobristKeys zobrist{};
+
+// Хэш позиции вместе с очередью хода и стороной, для которой считается оценка
+inline uint64_t zobrist_hash(const Position& pos, const bool color, const bool bot_color) {
+    uint64_t key = (color ? zobrist.black_move : 0) ^ (bot_color ? zobrist.black_bot : 0);
+    for (uint32_t occ = pos.occupied(); occ; occ &= occ - 1) {
+        const int sq = lsb(occ);
+        key ^= zobrist.piece[sq][pos.at(sq)];
+    }
+    return key;
+}
+
+// Тип оценки, сохраненной в таблице
+enum class Bound : uint8_t {
+    NONE,  // Пустая запись
+    EXACT, // Точная оценка
+    LOWER, // Оценка не меньше сохраненной (было отсечение на узле максимизирующего игрока)
+    UPPER  // Оценка не больше сохраненной (было отсечение на узле минимизирующего игрока)
+};
+
+// Запись таблицы транспозиций
+struct TTEntry {
+    uint64_t key = 0;          // Полный хэш позиции для проверки коллизий
+    double score = 0;          // Оценка позиции
+    int8_t depth = -1;         // Оставшаяся глубина перебора, с которой получена оценка
+    Bound bound = Bound::NONE; // Тип оценки
+    int8_t from = -1, to = -1; // Лучший ход (номера клеток начала и конца первого шага)
+};
+
+// Класс TranspositionTable хранит оценки уже просмотренных позиций фиксированного размера.
+// Таблица живет в Logic, сохраняется между ходами бота и общая для всех потоков перебора:
+// запись хранится в трех атомарных словах, а ключ - в виде XOR с данными, поэтому запись,
+// одновременно изменяемая другим потоком, при чтении просто не совпадет с ключом.
+class TranspositionTable {
+public:
+    TranspositionTable() = default;
+
+    // Выделение таблицы размером size_mb мегабайт (округляется вниз до степени двойки записей)
+    explicit TranspositionTable(const size_t size_mb) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Slot) <= (size_mb << 20)) {
+            count *= 2;
+        }
+        if (size_mb) {
+            table.reset(new Slot[count]);
+            mask = count - 1;
+        }
+    }
+
+    // Включена ли таблица
+    bool enabled() const {
+        return table != nullptr;
+    }
+
+    // Поиск записи по ключу. Возвращает false, если позиция не найдена
+    bool probe(const uint64_t key, TTEntry& entry) const {
+        const Slot& slot = table[key & mask];
+        const uint64_t check = slot.check.load(std::memory_order_relaxed);
+        const uint64_t score = slot.score.load(std::memory_order_relaxed);
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if (!data || (check ^ score ^ data) != key)
+            return false;
+        entry.key = key;
+        std::memcpy(&entry.score, &score, sizeof(score));
+        entry.depth = int8_t(data & 0xFF);
+        entry.bound = Bound((data >> 8) & 0xFF);
+        entry.from = int8_t((data >> 16) & 0xFF);
+        entry.to = int8_t((data >> 24) & 0xFF);
+        return true;
+    }
+
+    // Сохранение оценки. Запись той же позиции заменяется только результатом не меньшей глубины
+    void store(const uint64_t key, const int depth, const Bound bound, const double score, const move_pos& best) {
+        Slot& slot = table[key & mask];
+        TTEntry old;
+        if (probe(key, old) && old.depth > depth)
+            return;
+        const int8_t from = best.x == -1 ? -1 : int8_t(cell_to_sq(best.x, best.y));
+        const int8_t to = best.x == -1 ? -1 : int8_t(cell_to_sq(best.x2, best.y2));
+        uint64_t score_bits;
+        std::memcpy(&score_bits, &score, sizeof(score));
+        const uint64_t data = uint64_t(uint8_t(depth)) | (uint64_t(bound) << 8) | (uint64_t(uint8_t(from)) << 16) |
+            (uint64_t(uint8_t(to)) << 24);
+        slot.check.store(key ^ score_bits ^ data, std::memory_order_relaxed);
+        slot.score.store(score_bits, std::memory_order_relaxed);
+        slot.data.store(data, std::memory_order_relaxed);
+    }
+
+    // Очистка всех записей
+    void clear() {
+        for (size_t i = 0; table && i <= mask; ++i) {
+            table[i].check.store(0, std::memory_order_relaxed);
+            table[i].score.store(0, std::memory_order_relaxed);
+            table[i].data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    // Ячейка таблицы: проверочное слово (ключ XOR оценка XOR данные), оценка и упакованные
+    // глубина, тип оценки и лучший ход. Пустая ячейка имеет нулевое слово данных
+    struct Slot {
+        std::atomic<uint64_t> check{ 0 };
+        std::atomic<uint64_t> score{ 0 };
+        std::atomic<uint64_t> data{ 0 };
+    };
+
+    std::unique_ptr<Slot[]> table; // Ячейки таблицы
+    size_t mask = 0;               // Маска индекса (размер таблицы - степень двойки)
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include "MoveList.h"
+
+struct SplitPoint;
+
+// Задача для потока перебора: просмотр хода с номером index из точки разделения sp
+struct SplitTask {
+    SplitPoint* sp = nullptr; // Точка разделения (узел в стеке потока-владельца)
+    int index = 0;            // Номер хода в списке ходов узла
+};
+
+// Емкость очереди задач: в каждой точке разделения не больше MAX_MOVES - 1 задач, а точки разделения
+// на одном пути от корня идут на разных глубинах (до 64). Степень двойки для кольцевого буфера
+const size_t WORK_QUEUE_SIZE = 16384;
+static_assert(WORK_QUEUE_SIZE >= 64 * MAX_MOVES, "Work queue capacity");
+
+// Класс WorkQueue - очередь задач одного потока перебора (кольцевой буфер без выделения памяти).
+// Владелец кладет и забирает задачи с конца (сначала самые глубокие узлы),
+// свободные потоки крадут задачи из начала очереди.
+class WorkQueue {
+public:
+    // Добавление задачи владельцем
+    void push(const SplitTask& task) {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks[tail++ % WORK_QUEUE_SIZE] = task;
+        count.store(int(tail - head), std::memory_order_relaxed);
+    }
+
+    // Задача с конца очереди, если она принадлежит точке разделения sp
+    bool pop(const SplitPoint* sp, SplitTask& task) {
+        if (!count.load(std::memory_order_relaxed))
+            return false;
+        std::lock_guard<std::mutex> guard(lock);
+        if (head == tail || tasks[(tail - 1) % WORK_QUEUE_SIZE].sp != sp)
+            return false;
+        task = tasks[--tail % WORK_QUEUE_SIZE];
+        count.store(int(tail - head), std::memory_order_relaxed);
+        return true;
+    }
+
+    // Кража задачи из начала очереди, если она подходит под условие accept
+    template <typename Accept>
+    bool steal(SplitTask& task, Accept accept) {
+        if (!count.load(std::memory_order_relaxed))
+            return false;
+        std::lock_guard<std::mutex> guard(lock);
+        if (head == tail || !accept(tasks[head % WORK_QUEUE_SIZE]))
+            return false;
+        task = tasks[head++ % WORK_QUEUE_SIZE];
+        count.store(int(tail - head), std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::mutex lock;                       // Защита очереди
+    SplitTask tasks[WORK_QUEUE_SIZE];      // Задачи с номерами head..tail-1 (по модулю размера буфера)
+    size_t head = 0, tail = 0;             // Начало и конец очереди
+    std::atomic<int> count{ 0 };           // Размер очереди для проверки без блокировки
+};
@@ -2,36 +2,36 @@
 
 #include <stdlib.h>
 
-//   POS_T  int8_t     
+// Определение типа POS_T как int8_t для представления координат на доске
 typedef int8_t POS_T;
 
-//  move_pos     
+// Структура move_pos для представления хода в игре
 struct move_pos {
-    POS_T x, y;             //     ( )
-    POS_T x2, y2;           //     ( )
-    POS_T xb = -1, yb = -1; //    (  )
+    POS_T x, y;             // Координаты начальной позиции фигуры (откуда перемещается)
+    POS_T x2, y2;           // Координаты конечной позиции фигуры (куда перемещается)
+    POS_T xb = -1, yb = -1; // Координаты побитой фигуры (если есть удар)
 
-    //       
+    // Конструктор для создания хода без побитой фигуры
     move_pos(const POS_T x, const POS_T y, const POS_T x2, const POS_T y2)
         : x(x), y(y), x2(x2), y2(y2) {
-        //      
+        // Инициализация координат начала и конца хода
     }
 
-    //       
+    // Конструктор для создания хода с побитой фигурой
     move_pos(const POS_T x, const POS_T y, const POS_T x2, const POS_T y2, const POS_T xb, const POS_T yb)
         : x(x), y(y), x2(x2), y2(y2), xb(xb), yb(yb) {
-        //   ,    
+        // Инициализация координат начала, конца и побитой фигуры
     }
 
-    //   ==    
+    // Перегрузка оператора == для сравнения двух ходов
     bool operator==(const move_pos& other) const {
         return (x == other.x && y == other.y && x2 == other.x2 && y2 == other.y2);
-        //  true,     
+        // Возвращаем true, если все соответствующие координаты равны
     }
 
-    //   !=    
+    // Перегрузка оператора != для сравнения двух ходов
     bool operator!=(const move_pos& other) const {
         return !(*this == other);
-        //  true,     (    ==)
+        // Возвращаем true, если ходы не равны (используем уже определенный оператор ==)
     }
 };
\ No newline at end of file
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Move.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Битовые операции над 32-битными масками игровых клеток
+#ifdef _MSC_VER
+inline int popcount(const uint32_t mask) {
+    return int(__popcnt(mask)); // Количество установленных битов
+}
+inline int lsb(const uint32_t mask) {
+    unsigned long idx;
+    _BitScanForward(&idx, mask); // Номер младшего установленного бита
+    return int(idx);
+}
+inline int msb(const uint32_t mask) {
+    unsigned long idx;
+    _BitScanReverse(&idx, mask); // Номер старшего установленного бита
+    return int(idx);
+}
+#else
+inline int popcount(const uint32_t mask) {
+    return __builtin_popcount(mask); // Количество установленных битов
+}
+inline int lsb(const uint32_t mask) {
+    return __builtin_ctz(mask); // Номер младшего установленного бита
+}
+inline int msb(const uint32_t mask) {
+    return 31 - __builtin_clz(mask); // Номер старшего установленного бита
+}
+#endif
+
+// Обратный порядок битов маски (бит sq переходит в бит 31 - sq)
+inline uint32_t reverse_bits(uint32_t mask) {
+    mask = ((mask >> 1) & 0x55555555u) | ((mask & 0x55555555u) << 1);
+    mask = ((mask >> 2) & 0x33333333u) | ((mask & 0x33333333u) << 2);
+    mask = ((mask >> 4) & 0x0F0F0F0Fu) | ((mask & 0x0F0F0F0Fu) << 4);
+    mask = ((mask >> 8) & 0x00FF00FFu) | ((mask & 0x00FF00FFu) << 8);
+    return (mask >> 16) | (mask << 16);
+}
+
+// Игровые (темные) клетки доски нумеруются от 0 до 31 построчно: sq = x * 4 + y / 2
+constexpr int cell_to_sq(const POS_T x, const POS_T y) {
+    return x * 4 + y / 2;
+}
+
+// Строка клетки с номером sq
+constexpr POS_T sq_x(const int sq) {
+    return POS_T(sq / 4);
+}
+
+// Столбец клетки с номером sq (в четных строках игровые клетки стоят на нечетных столбцах)
+constexpr POS_T sq_y(const int sq) {
+    return POS_T(2 * (sq % 4) + 1 - (sq / 4) % 2);
+}
+
+// Маски строк доски
+constexpr uint32_t row_mask(const POS_T x) {
+    return uint32_t(0xF) << (x * 4);
+}
+
+// Сведения для отмены хода (Position::unmake): побитая фигура и превращение в дамку
+struct UndoRecord {
+    POS_T captured = 0;     // Тип побитой фигуры на клетке (xb, yb) хода (0 - удара не было)
+    bool promotion = false; // Шашка стала дамкой на последней горизонтали
+};
+
+// Структура Position хранит позицию в трех битовых масках по 32 игровым клеткам.
+// Используется при переборе вместо матрицы 8x8: позиция копируется за несколько регистров и не требует выделения памяти.
+struct Position {
+    uint32_t white = 0; // Клетки с белыми шашками и дамками
+    uint32_t black = 0; // Клетки с черными шашками и дамками
+    uint32_t kings = 0; // Клетки с дамками обоих цветов
+
+    Position() = default;
+
+    // Построение позиции по матрице доски (1 - белая шашка, 2 - черная, 3 - белая дамка, 4 - черная)
+    explicit Position(const std::vector<std::vector<POS_T>>& mtx) {
+        for (POS_T i = 0; i < 8; ++i) {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2) {
+                if (mtx[i][j]) {
+                    set(cell_to_sq(i, j), mtx[i][j]);
+                }
+            }
+        }
+    }
+
+    // Построение позиции по строке из 32 символов (по клеткам 0..31): '.' - пусто,
+    // 'w'/'b' - белая/черная шашка, 'W'/'B' - белая/черная дамка. Используется в инструментах и тестовых позициях
+    explicit Position(const std::string& str) {
+        for (int sq = 0; sq < 32 && sq < int(str.size()); ++sq) {
+            const size_t type = std::string(".wbWB").find(str[sq]);
+            if (type != std::string::npos && type) {
+                set(sq, POS_T(type));
+            }
+        }
+    }
+
+    // Запись позиции в строку из 32 символов (обратно конструктору из строки)
+    std::string to_string() const {
+        std::string str(32, '.');
+        for (int sq = 0; sq < 32; ++sq) {
+            str[sq] = ".wbWB"[at(sq)];
+        }
+        return str;
+    }
+
+    // Обратное преобразование в матрицу 8x8 (для отрисовки и отладки)
+    std::vector<std::vector<POS_T>> to_mtx() const {
+        std::vector<std::vector<POS_T>> mtx(8, std::vector<POS_T>(8, 0));
+        for (int sq = 0; sq < 32; ++sq) {
+            mtx[sq_x(sq)][sq_y(sq)] = at(sq);
+        }
+        return mtx;
+    }
+
+    // Маска фигур заданного цвета (0 - белые, 1 - черные)
+    uint32_t pieces(const bool color) const {
+        return color ? black : white;
+    }
+
+    // Маска всех занятых клеток
+    uint32_t occupied() const {
+        return white | black;
+    }
+
+    // Тип фигуры на клетке в кодировке матрицы доски (0 - пусто)
+    POS_T at(const int sq) const {
+        const uint32_t bit = uint32_t(1) << sq;
+        if (!(occupied() & bit))
+            return 0;
+        return POS_T(((black & bit) ? 2 : 1) + ((kings & bit) ? 2 : 0));
+    }
+
+    POS_T at(const POS_T x, const POS_T y) const {
+        return at(cell_to_sq(x, y));
+    }
+
+    // Установка фигуры заданного типа на клетку
+    void set(const int sq, const POS_T type) {
+        const uint32_t bit = uint32_t(1) << sq;
+        clear(sq);
+        if (type % 2)
+            white |= bit;
+        else
+            black |= bit;
+        if (type > 2)
+            kings |= bit;
+    }
+
+    // Очистка клетки
+    void clear(const int sq) {
+        const uint32_t bit = ~(uint32_t(1) << sq);
+        white &= bit;
+        black &= bit;
+        kings &= bit;
+    }
+
+    // Новая позиция после хода turn (с превращением шашки в дамку на последней горизонтали)
+    Position make_turn(const move_pos& turn) const {
+        Position res = *this;
+        UndoRecord undo;
+        res.make(turn, undo);
+        return res;
+    }
+
+    // Ход turn на месте. В undo записывается все, что нужно для отмены хода
+    void make(const move_pos& turn, UndoRecord& undo) {
+        const uint32_t from = uint32_t(1) << cell_to_sq(turn.x, turn.y), to = uint32_t(1) << cell_to_sq(turn.x2, turn.y2);
+        undo.captured = 0;
+        if (turn.xb != -1) { // Если есть побитая фигура, убираем её
+            const int sq = cell_to_sq(turn.xb, turn.yb);
+            undo.captured = at(sq);
+            clear(sq);
+        }
+        const bool is_black = (black & from) != 0;
+        uint32_t& own = is_black ? black : white;
+        own ^= from | to;
+        if (kings & from) {
+            kings ^= from | to;
+            undo.promotion = false;
+        }
+        else { // Превращение в дамку
+            undo.promotion = turn.x2 == (is_black ? 7 : 0);
+            if (undo.promotion)
+                kings |= to;
+        }
+    }
+
+    // Отмена хода turn, сделанного make с записью undo
+    void unmake(const move_pos& turn, const UndoRecord& undo) {
+        const uint32_t from = uint32_t(1) << cell_to_sq(turn.x, turn.y), to = uint32_t(1) << cell_to_sq(turn.x2, turn.y2);
+        uint32_t& own = (black & to) ? black : white;
+        own ^= from | to;
+        if (undo.promotion)
+            kings &= ~to;
+        else if (kings & to)
+            kings ^= from | to;
+        if (undo.captured) { // Возвращаем побитую фигуру
+            set(cell_to_sq(turn.xb, turn.yb), undo.captured);
+        }
+    }
+
+    // Позиция, повернутая на 180 градусов с заменой цвета фигур: ход черных в исходной позиции
+    // равносилен ходу белых в повернутой (клетка sq переходит в клетку 31 - sq)
+    Position flipped() const {
+        Position res;
+        res.white = reverse_bits(black);
+        res.black = reverse_bits(white);
+        res.kings = reverse_bits(kings);
+        return res;
+    }
+
+    bool operator==(const Position& other) const {
+        return white == other.white && black == other.black && kings == other.kings;
+    }
+
+    bool operator!=(const Position& other) const {
+        return !(*this == other);
+    }
+};
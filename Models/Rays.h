@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include "Position.h"
+
+// Номер клетки-заглушки за пределами доски. Бит 32 в 64-битной маске занятости всегда установлен,
+// поэтому ходы и удары за край доски отбрасываются обычной проверкой занятости, без проверок границ.
+const int OFF_BOARD = 32;
+
+// Направления по диагоналям: 0 - (-1, -1), 1 - (-1, +1), 2 - (+1, -1), 3 - (+1, +1)
+constexpr int dir_dx(const int d) {
+    return d < 2 ? -1 : 1;
+}
+
+constexpr int dir_dy(const int d) {
+    return d % 2 ? 1 : -1;
+}
+
+// Направления с ростом номера клетки (вниз по доске)
+constexpr bool dir_forward(const int d) {
+    return d >= 2;
+}
+
+// Таблицы соседей, ударов и лучей для каждой игровой клетки, вычисляемые на этапе компиляции
+struct RayTables {
+    int8_t step[32][4];      // Соседняя клетка по направлению
+    int8_t jump_over[32][4]; // Клетка, через которую шашка бьет по направлению
+    int8_t jump_to[32][4];   // Клетка, на которую шашка встает после удара
+    uint32_t ray[32][4];     // Маска всех клеток диагонали от клетки до края доски (без самой клетки)
+
+    constexpr RayTables() : step(), jump_over(), jump_to(), ray() {
+        for (int sq = 0; sq < 32; ++sq) {
+            for (int d = 0; d < 4; ++d) {
+                const int x = sq_x(sq), y = sq_y(sq);
+                step[sq][d] = jump_over[sq][d] = jump_to[sq][d] = OFF_BOARD;
+                ray[sq][d] = 0;
+                for (int k = 1; k < 8; ++k) {
+                    const int x2 = x + k * dir_dx(d), y2 = y + k * dir_dy(d);
+                    if (x2 < 0 || x2 > 7 || y2 < 0 || y2 > 7)
+                        break;
+                    const int sq2 = cell_to_sq(POS_T(x2), POS_T(y2));
+                    ray[sq][d] |= uint32_t(1) << sq2;
+                    if (k == 1) {
+                        step[sq][d] = int8_t(sq2);
+                    }
+                    if (k == 2) {
+                        jump_over[sq][d] = step[sq][d];
+                        jump_to[sq][d] = int8_t(sq2);
+                    }
+                }
+            }
+        }
+    }
+};
+
+constexpr RayTables rays{};
+
+// Ближайшая к клетке занятая клетка из маски blockers, лежащих на луче по направлению d
+inline int nearest_on_ray(const uint32_t blockers, const int d) {
+    return dir_forward(d) ? lsb(blockers) : msb(blockers);
+}
+
+// Свободные клетки луча sq по направлению d до первой занятой клетки (не включая её)
+inline uint32_t free_ray(const int sq, const int d, const uint32_t occupied) {
+    const uint32_t blockers = rays.ray[sq][d] & occupied;
+    if (!blockers)
+        return rays.ray[sq][d];
+    const int b = nearest_on_ray(blockers, d);
+    return rays.ray[sq][d] & ~rays.ray[b][d] & ~(uint32_t(1) << b);
+}
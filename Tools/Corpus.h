@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include "../Game/MappedFile.h"
+#include "../Models/Position.h"
+
+// Корпус позиций для подбора весов оценки (Tools/tune_gen.cpp пишет, Tools/tune.cpp читает):
+// заголовок и записи постоянного размера по 16 байт, поэтому миллионы позиций занимают десятки мегабайт
+// и читаются отображением файла в память, без разбора текста.
+
+// Сигнатура файла корпуса
+const char CORPUS_MAGIC[8] = { 'C', 'K', 'T', 'E', 'X', 'E', 'L', '1' };
+
+// Заголовок файла: сигнатура и количество записей
+struct CorpusHeader {
+    char magic[8];
+    uint64_t count;
+};
+
+// Позиция корпуса: маски фигур (как в Position), результат партии и очередь хода
+struct CorpusRecord {
+    uint32_t white, black, kings;
+    uint8_t result; // Результат партии со стороны белых: 0 - поражение, 1 - ничья, 2 - победа
+    uint8_t color;  // Очередь хода (0 - белые, 1 - черные)
+    uint16_t ply;   // Номер полухода в партии
+};
+
+static_assert(sizeof(CorpusHeader) == 16 && sizeof(CorpusRecord) == 16, "Corpus file layout");
+
+// Класс CorpusWriter - запись корпуса по мере игры: записи сразу уходят в буферизованный поток,
+// количество в заголовке исправляется при закрытии
+class CorpusWriter {
+public:
+    bool open(const std::string& path) {
+        fout.open(path, std::ios::binary | std::ios::trunc);
+        CorpusHeader header{};
+        std::memcpy(header.magic, CORPUS_MAGIC, sizeof(header.magic));
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        count = 0;
+        return bool(fout);
+    }
+
+    void write(const CorpusRecord& record) {
+        fout.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        ++count;
+    }
+
+    // Запись количества в заголовок и закрытие файла. Возвращает false при ошибке записи
+    bool close() {
+        fout.seekp(offsetof(CorpusHeader, count));
+        fout.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        fout.close();
+        return !fout.fail();
+    }
+
+    uint64_t size() const {
+        return count;
+    }
+
+private:
+    std::ofstream fout;
+    uint64_t count = 0;
+};
+
+// Класс CorpusReader - корпус, отображенный в память только для чтения
+class CorpusReader {
+public:
+    // Открытие файла корпуса. Возвращает false, если файла нет или он поврежден
+    bool open(const std::string& path) {
+        count = 0;
+        if (!file.open(path))
+            return false;
+        CorpusHeader header;
+        if (file.size() < sizeof(header)) {
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, CORPUS_MAGIC, sizeof(header.magic)) != 0 ||
+            file.size() < sizeof(header) + header.count * sizeof(CorpusRecord)) {
+            file.close();
+            return false;
+        }
+        count = size_t(header.count);
+        return true;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // Запись с номером i
+    CorpusRecord record(const size_t i) const {
+        CorpusRecord res;
+        std::memcpy(&res, file.data() + sizeof(CorpusHeader) + i * sizeof(CorpusRecord), sizeof(res));
+        return res;
+    }
+
+private:
+    MappedFile file;
+    size_t count = 0;
+};
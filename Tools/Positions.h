@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include "../Models/Move.h"
+
+// Фиксированные позиции для бенчмарков (строка по клеткам 0..31 в формате Position::to_string и очередь хода).
+// Получены случайными партиями из начальной позиции, поэтому все они достижимы в игре.
+struct BenchPosition {
+    const char* board; // Позиция
+    bool color;        // Очередь хода (0 - белые, 1 - черные)
+};
+
+const BenchPosition bench_positions[] = {
+    { "bbbbbbbbbbbb........wwwwwwwwwwww", 0 }, // Начальная позиция
+    { "bb..bb..b........w....b....ww.ww", 0 },
+    { "bb.bbb.wb..bw.......ww..w..ww...", 1 },
+    { "b.bbbb.bb.....b..w..wwww...wwwww", 0 },
+    { "bb.bb.bb..bb..wbw...w..ww...www.", 1 },
+    { "b...b.bbb.b....bw....www...wwww.", 0 },
+    { "b.bbbb.....b...w...w....wwwbw.ww", 1 },
+    { "bbbbwb......bbbb.....w.wwwwwwww.", 0 },
+    { "bbbbbb.bb........w.bww.w.w.wwwww", 1 },
+};
+
+// Позиции для Tools/bench.cpp: дебюты, середины игры и окончания с дамками
+const BenchPosition search_positions[] = {
+    // Дебюты
+    { "bbbbbbbbbbbb........wwwwwwwwwwww", 0 },
+    { "bbbb.bbb.b.b........bw.www.wwwww", 0 },
+    { "bbbb.bbbbbbb........wwb.ww.wwwww", 0 },
+    { "bbbb.bbbbbbbb...w.w..ww.wwwwwwww", 0 },
+    { "bbbbb.bb..bb........wb.ww.wwwwww", 0 },
+    { "bbbbb.bbbb.b....wbw..w.ww.wwwwww", 0 },
+    { "bbbbb.bbbbbb.....bwwwww.www.wwww", 0 },
+    { "bbbbb.bbbbbb...bw..w....wwwwwwww", 1 },
+    { "bbbbbb.bb.bb.b......www.wwwwwwww", 0 },
+    { "bbbbbb.bbbbb..w.....bwww.wwwwwww", 1 },
+    // Середины игры
+    { "bb..bb..b........w....b....ww.ww", 0 },
+    { "bb.bbb.wb..bw.......ww..w..ww...", 1 },
+    { "b.bbbb.bb.....b..w..wwww...wwwww", 0 },
+    { "bb.bb.bb..bb..wbw...w..ww...www.", 1 },
+    { "b...b.bbb.b....bw....www...wwww.", 0 },
+    { "b.bbbb.....b...w...w....wwwbw.ww", 1 },
+    { "bbbbwb......bbbb.....w.wwwwwwww.", 0 },
+    { "bbbbbb.bb........w.bww.w.w.wwwww", 1 },
+    { "...bbb.b..b....bW...ww.ww..w..ww", 0 },
+    { "..bbb..b.bbb...b.w..w..ww.www..w", 1 },
+    { "..bbbb..b.w....bw.bb.ww..w..ww..", 1 },
+    { ".b..bb.bb.bb...bw....w...wwww.w.", 1 },
+    { ".b.bbbb.b.bb.w....ww...w...www.w", 1 },
+    { ".bb.bb.b...b..wb.w..w...w...w.w.", 0 },
+    { ".bbb..b..bbb...b..w.w.ww.w.wwwww", 0 },
+    { ".bbbb.b.bb.b..b....bw.w.w..w.www", 0 },
+    { ".bbbbbb....b..b....ww.w.ww.w.www", 1 },
+    { ".bbbbbbb.b.wbb.b..ww.w....wwwwww", 0 },
+    // Окончания с дамками
+    { "...................B.Wb.....w...", 1 },
+    { "..................Bb...W..w.....", 0 },
+    { ".............b....WB.......w....", 0 },
+    { "...........b.....w.......W..B...", 1 },
+    { "..........W..b.....w........wB..", 0 },
+    { "....B.......W.......b....wwww...", 1 },
+    { "....W..b........b...........w.B.", 0 },
+    { "....bb...b.bb....W.w.........B..", 0 },
+    { "...b..........Bb....W....ww.w...", 1 },
+    { "..Wb.b.......b.........w.....B..", 1 },
+    { "...........wb..w.....W.....w.B..", 0 },
+    { "..........b.w.B...b.w......w....", 0 },
+};
+
+// Название клетки в шахматной нотации: вертикаль a..h слева направо, горизонталь 1..8 снизу вверх (от белых)
+inline std::string cell_name(const POS_T x, const POS_T y) {
+    return std::string(1, char('a' + y)) + char('1' + 7 - x);
+}
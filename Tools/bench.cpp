@@ -0,0 +1,408 @@
+// Бенчмарк перебора: лучший ход во всех позициях search_positions из Positions.h на глубины 1..depth.
+// Для каждой позиции глубины просматриваются подряд с общей таблицей транспозиций, как при углублении по времени,
+// поэтому время до глубины d - суммарное время глубин 1..d. Перед каждой позицией состояние бота сбрасывается
+// (Logic::new_game), так что результат позиции не зависит от остальных.
+// Вывод - по одному объекту JSON в строке (удобно сравнивать версии через diff):
+//   {"position":i,"depth":d,"nodes":...,"time_ms":...,"move":"c3-d4"} - для каждой позиции и глубины
+//   {"nn_kernel_check":"avx2","cases":...,"same":true} - сначала проверка векторных ядер сети на крайних весах
+//    и активациях (check_nn_kernels, не зависит от файла NetworkFile); при расхождении бенчмарк завершается с кодом 1
+//   {"leaf_scan":"avx2","leaves":...,"time_ms":...,"leaves_per_sec":...,"same":true} - скорость пакетного разбора
+//    листьев последнего уровня (LeafBatch.h) каждым поддерживаемым набором инструкций; same - удары и число ходов
+//    совпали с генератором ходов (bench_leaf_scan), иначе бенчмарк завершается с кодом 1
+//   {"eval":"NeuralNetwork","eval_kernel":"avx2","leaves":...,"time_ms":...,"leaves_per_sec":...,"same":true} -
+//    затем скорость оценки листьев (Evaluator::update и Evaluator::score) всех ходов позиций в каждом режиме
+//    BotScoringType. NumberOnly и NumberAndPotential считаются только обычным кодом ("eval_kernel":"scalar"),
+//    векторные ядра есть только у NeuralNetwork (если загружен файл NetworkFile): она меряется каждым
+//    поддерживаемым процессором набором инструкций, same - оценки совпали до бита со скалярным кодом
+//   {"depth":d,"nodes":...,"qnodes":...,"time_ms":...} - суммы по всем позициям (время до глубины)
+//   {"positions":...,"depth":...,"threads":...,"nodes":...,"qnodes":...,"stand_pats":...,"time_ms":...,"nps":...,
+//    "allocations":...,"signature":"..."} - итог
+// qnodes - узлы форсированного перебора ударов на предельной глубине и за ней (входят в nodes),
+// stand_pats - спокойные позиции, в которых он закончился статической оценкой.
+// Подпись - хэш количеств узлов и найденных ходов: она меняется при любом изменении дерева перебора,
+// но не зависит от скорости машины. При одном потоке подпись воспроизводима, при нескольких - нет.
+// allocations - количество выделений памяти в куче внутри find_best_turns (глобальные operator new заменены
+// счетчиком). При одном потоке перебор не должен выделять память вообще: ожидается 0.
+// Настройки берутся из settings.json, кроме детерминированного режима, поиска на фиксированную глубину,
+// размера таблицы транспозиций (16 МБ), дебютной книги, таблиц окончаний и подобранных весов оценки (отключены).
+// Запуск из папки с settings.json: bench [глубина] [потоков] (по умолчанию 10 и 1).
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include "../Game/Logic.h"
+#include "Positions.h"
+
+// Счетчик выделений памяти в куче: все выделения программы идут через замененные operator new.
+// Обычные operator new и operator delete не встраиваются, остальные формы вызывают их, иначе после
+// встраивания компилятор видит malloc и free на месте new и delete (-Wmismatched-new-delete)
+#ifdef _MSC_VER
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+static atomic<size_t> heap_allocations{ 0 };
+
+BENCH_NOINLINE void* operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    if (void* ptr = malloc(size ? size : 1))
+        return ptr;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+
+BENCH_NOINLINE void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+// Хэш FNV-1a для подписи
+struct Signature
+{
+    uint64_t value = 14695981039346656037ull;
+
+    void add(uint64_t data)
+    {
+        for (int i = 0; i < 8; ++i, data >>= 8)
+        {
+            value = (value ^ (data & 0xFF)) * 1099511628211ull;
+        }
+    }
+};
+
+// Запись хода: клетки через "-" для тихого хода и через ":" для серии ударов
+string line_name(const MoveList& line)
+{
+    if (line.empty())
+        return "";
+    string res = cell_name(line[0].x, line[0].y);
+    for (const auto& turn : line)
+    {
+        res += (turn.xb == -1 ? "-" : ":") + cell_name(turn.x2, turn.y2);
+    }
+    return res;
+}
+
+// Проверка векторных ядер сети на крайних значениях, которые допускает Tools/nnue_train.cpp и которых может не быть
+// в файле весов: насыщенные активации (аккумулятор 127 и за пределами 0..127), веса второго слоя +-127
+// и выходного +-32767. Для каждого поддерживаемого набора инструкций kernel выход и обновление аккумулятора
+// сравниваются со скалярным кодом; false - хотя бы одно расхождение
+bool check_nn_kernels()
+{
+    bool all_same = true;
+#ifdef EVAL_X86 // На остальных платформах векторных ядер нет
+    mt19937 rng(12345);
+    const auto random_int = [&rng](const int low, const int high) {
+        return uniform_int_distribution<int>(low, high)(rng);
+    };
+    auto weights = make_unique<NetworkWeights>();
+    NetworkWeights& w = *weights;
+    alignas(32) int16_t acc[NN_HIDDEN], expected[NN_HIDDEN], column[NN_HIDDEN];
+    for (const EvalKernel kernel : { EvalKernel::SSE41, EvalKernel::AVX2 })
+    {
+        if (!eval_kernel_supported(kernel))
+            continue;
+        bool same = true;
+        int cases = 0;
+        for (int w2_mode = 0; w2_mode < 8; ++w2_mode)
+        {
+            for (int acc_mode = 0; acc_mode < 6; ++acc_mode)
+            {
+                for (int k = 0; k < NN_HIDDEN2; ++k)
+                {
+                    for (int j = 0; j < NN_HIDDEN; ++j)
+                    {
+                        const int values[] = { 127, -127, 70, (j % 2 ? -127 : 127), (j < NN_HIDDEN / 2 ? 127 : -127),
+                            (k % 2 ? -127 : 127), random_int(-127, 127), random_int(-1, 1) * 127 };
+                        w.w2[k][j] = int8_t(values[w2_mode]);
+                    }
+                    w.b2[k] = acc_mode % 2 ? 0 : random_int(-NN_QA * NN_QB * 8, NN_QA * NN_QB * 8);
+                    w.w3[k] = int16_t(w2_mode < 4 ? (k % 2 ? -32767 : 32767) : random_int(-32767, 32767));
+                }
+                w.b3 = random_int(-1000000, 1000000);
+                for (int j = 0; j < NN_HIDDEN; ++j)
+                {
+                    const int values[] = { NN_QA, 32767, -32768, (j % 2 ? NN_QA : 0), random_int(-32768, 32767),
+                        random_int(0, NN_QA) };
+                    acc[j] = int16_t(values[acc_mode]);
+                }
+                const int32_t out = kernel == EvalKernel::AVX2 ? nn_forward_avx2(w, acc) : nn_forward_sse41(w, acc);
+                same = same && out == nn_forward_scalar(w, acc);
+                ++cases;
+            }
+        }
+        for (int r = 0; r < 1000; ++r, ++cases) // Обновление аккумулятора с переполнением int16
+        {
+            for (int j = 0; j < NN_HIDDEN; ++j)
+            {
+                acc[j] = expected[j] = int16_t(random_int(-32768, 32767));
+                column[j] = int16_t(random_int(-32768, 32767));
+            }
+            const int sign = r % 2 ? 1 : -1;
+            nn_update_scalar(expected, column, sign);
+            if (kernel == EvalKernel::AVX2)
+                nn_update_avx2(acc, column, sign);
+            else
+                nn_update_sse41(acc, column, sign);
+            same = same && equal(acc, acc + NN_HIDDEN, expected);
+        }
+        printf("{\"nn_kernel_check\":\"%s\",\"cases\":%d,\"same\":%s}\n", eval_kernel_name(kernel), cases,
+            same ? "true" : "false");
+        all_same = all_same && same;
+    }
+#endif
+    return all_same;
+}
+
+// Оценки листьев после каждого из ходов turns позиции pos со слагаемыми ev - так же, как в переборе
+void score_leaves(const Evaluator& evaluator, const EvalTerms& ev, const Position& pos, const MoveList& turns,
+    const bool first_bot_color, double* out)
+{
+    for (size_t i = 0; i < turns.size(); ++i)
+    {
+        EvalTerms child = ev;
+        evaluator.update(child, pos, turns[i]);
+        out[i] = evaluator.score(child, first_bot_color);
+    }
+}
+
+// Скорость оценки листьев в режиме mode набором инструкций kernel: все ходы всех позиций
+// search_positions, repeats повторов. Оценки сравниваются с оценками скалярного кода
+void bench_eval(Logic& logic, const Evaluator& mode_evaluator, const string& mode, const EvalKernel kernel,
+    const int repeats)
+{
+    Evaluator evaluator = mode_evaluator;
+    Evaluator scalar = evaluator;
+    evaluator.set_kernel(kernel);
+    scalar.set_kernel(EvalKernel::SCALAR);
+    const int count = int(sizeof(search_positions) / sizeof(search_positions[0]));
+    vector<Position> positions;
+    vector<EvalTerms> terms;
+    vector<MoveList> moves;
+    for (int i = 0; i < count; ++i)
+    {
+        positions.emplace_back(string(search_positions[i].board));
+        terms.push_back(evaluator.init(positions.back()));
+        logic.find_turns(search_positions[i].color, positions.back());
+        moves.emplace_back();
+        for (const auto& turn : logic.turns)
+        {
+            moves.back().push_back(turn);
+        }
+    }
+
+    bool same = true;
+    size_t leaves = 0;
+    double checksum = 0, scores[MAX_MOVES], expected[MAX_MOVES];
+    const auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            score_leaves(evaluator, terms[i], positions[i], moves[i], search_positions[i].color, scores);
+            leaves += moves[i].size();
+            checksum += scores[0];
+        }
+    }
+    const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    volatile double sink = checksum; // Оценки должны использоваться, иначе компилятор выбросит цикл
+    (void)sink;
+    for (int i = 0; i < count; ++i)
+    {
+        score_leaves(evaluator, terms[i], positions[i], moves[i], search_positions[i].color, scores);
+        score_leaves(scalar, terms[i], positions[i], moves[i], search_positions[i].color, expected);
+        same = same && equal(scores, scores + moves[i].size(), expected);
+    }
+    printf("{\"eval\":\"%s\",\"eval_kernel\":\"%s\",\"leaves\":%zu,\"time_ms\":%.3f,\"leaves_per_sec\":%.0f,"
+        "\"same\":%s}\n", mode.c_str(), eval_kernel_name(kernel), leaves, ms, leaves / max(ms, 1e-3) * 1000,
+        same ? "true" : "false");
+}
+
+// Разбор листьев пакетом (LeafBatch.h): листья - позиции через два хода от позиций search_positions, ходит
+// тот же игрок (в пакете цвет ходящего один, поэтому пакеты белых и черных отдельные). Каждым поддерживаемым
+// набором инструкций все пакеты разбираются repeats раз, результат сравнивается с генератором ходов Logic
+// (есть ли удары, а без ударов - число ходов); false - хотя бы одно расхождение
+bool bench_leaf_scan(Logic& logic, const int repeats)
+{
+    vector<LeafBatch> batches[2];       // Пакеты листьев, где ходят белые и черные
+    vector<uint32_t> beats[2], moves[2]; // Ожидаемые результаты по листьям: есть ли удары, число ходов без ударов
+    const int count = int(sizeof(search_positions) / sizeof(search_positions[0]));
+    for (int i = 0; i < count; ++i)
+    {
+        const bool color = search_positions[i].color;
+        const Position pos{ string(search_positions[i].board) };
+        logic.find_turns(color, pos);
+        const vector<move_pos> turns = logic.turns;
+        for (const auto& turn : turns)
+        {
+            const Position child = pos.make_turn(turn);
+            logic.find_turns(!color, child);
+            const vector<move_pos> replies = logic.turns;
+            for (const auto& reply : replies)
+            {
+                const Position leaf = child.make_turn(reply);
+                logic.find_turns(color, leaf);
+                const size_t lane = beats[color].size() % LEAF_BATCH_SIZE;
+                if (lane == 0)
+                    batches[color].emplace_back(LeafBatch{});
+                LeafBatch& batch = batches[color].back();
+                batch.men[lane] = leaf.pieces(color) & ~leaf.kings;
+                batch.kings[lane] = leaf.pieces(color) & leaf.kings;
+                batch.opp[lane] = leaf.pieces(color ^ 1);
+                beats[color].push_back(logic.have_beats ? 1 : 0);
+                moves[color].push_back(logic.have_beats ? 0 : uint32_t(logic.turns.size()));
+            }
+        }
+    }
+    const size_t total = beats[0].size() + beats[1].size();
+
+    bool all_same = true;
+    for (const EvalKernel kernel : { EvalKernel::SCALAR, EvalKernel::SSE41, EvalKernel::AVX2 })
+    {
+        if (!eval_kernel_supported(kernel))
+            continue;
+        bool same = true;
+        uint32_t checksum = 0;
+        double ms = 0;
+        for (int color = 0; color < 2; ++color)
+        {
+            vector<LeafBatch> work = batches[color];
+            const auto start = chrono::steady_clock::now();
+            for (int r = 0; r < repeats; ++r)
+            {
+                for (auto& batch : work)
+                {
+                    leaf_scan(batch, color, kernel);
+                    checksum += batch.moves[0];
+                }
+            }
+            ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            for (size_t j = 0; j < beats[color].size(); ++j)
+            {
+                const LeafBatch& batch = work[j / LEAF_BATCH_SIZE];
+                const size_t lane = j % LEAF_BATCH_SIZE;
+                const uint32_t leaf_beats = batch.beats[lane] ? 1 : 0;
+                same = same && leaf_beats == beats[color][j] && (leaf_beats || batch.moves[lane] == moves[color][j]);
+            }
+        }
+        volatile uint32_t sink = checksum; // Результат должен использоваться, иначе компилятор выбросит цикл
+        (void)sink;
+        printf("{\"leaf_scan\":\"%s\",\"leaves\":%zu,\"time_ms\":%.3f,\"leaves_per_sec\":%.0f,\"same\":%s}\n",
+            eval_kernel_name(kernel), total * repeats, ms, total * repeats / max(ms, 1e-3) * 1000,
+            same ? "true" : "false");
+        all_same = all_same && same;
+    }
+
+    return all_same;
+}
+
+int main(int argc, char** argv)
+{
+    const int depth = argc > 1 ? max(1, atoi(argv[1])) : 10;
+    const int threads = argc > 2 ? atoi(argv[2]) : 1;
+    Config config;
+    config.set("Bot", "NoRandom", true); // Одинаковое дерево перебора при каждом запуске
+    config.set("Bot", "BotTimeMS", 0);   // Перебор на фиксированную глубину
+    config.set("Bot", "Threads", threads);
+    config.set("Bot", "TTSizeMB", 16);
+    config.set("Bot", "BookFile", "");   // Позиции должны перебираться, а не браться из файлов
+    config.set("Bot", "EndgameFile", "");
+    config.set("Bot", "WeightsFile", ""); // Ручные веса: подпись не зависит от файлов рядом с settings.json
+    Logic logic(&config);
+    if (!check_nn_kernels())
+    {
+        printf("Network kernels differ from the scalar code\n");
+        return 1;
+    }
+    if (!bench_leaf_scan(logic, 200))
+    {
+        printf("Leaf batch kernels differ from the move generator\n");
+        return 1;
+    }
+    for (const string mode : { "NumberOnly", "NumberAndPotential", "NeuralNetwork" })
+    {
+        const Evaluator evaluator(mode, config("Bot", "NetworkFile").get<string>());
+        if (mode == "NeuralNetwork" && !evaluator.neural())
+            continue; // Нет файла весов
+        for (const EvalKernel kernel : { EvalKernel::SCALAR, EvalKernel::SSE41, EvalKernel::AVX2 })
+        {
+            // Векторные ядра есть только у нейросети, оценка материала всегда считается обычным кодом
+            if (eval_kernel_supported(kernel) && (kernel == EvalKernel::SCALAR || evaluator.neural()))
+                bench_eval(logic, evaluator, mode, kernel, 20000);
+        }
+    }
+
+    const int count = int(sizeof(search_positions) / sizeof(search_positions[0]));
+    vector<size_t> depth_nodes(depth + 1, 0); // Суммы по глубинам
+    vector<size_t> depth_qnodes(depth + 1, 0);
+    vector<double> depth_ms(depth + 1, 0);
+    Signature signature;
+    size_t allocations = 0; // Выделения памяти внутри find_best_turns
+    for (int i = 0; i < count; ++i)
+    {
+        const Position pos{ string(search_positions[i].board) };
+        const bool color = search_positions[i].color;
+        logic.new_game(0);
+        double ms = 0;
+        for (int d = 1; d <= depth; ++d)
+        {
+            logic.Max_depth = d;
+            const size_t nodes_before = logic.nodes(), qnodes_before = logic.qnodes();
+            const size_t allocations_before = heap_allocations.load();
+            const auto start = chrono::steady_clock::now();
+            const auto line = logic.find_best_turns(color, pos);
+            ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            allocations += heap_allocations.load() - allocations_before;
+            const size_t nodes = logic.nodes() - nodes_before;
+            const string move = line_name(line);
+            printf("{\"position\":%d,\"depth\":%d,\"nodes\":%zu,\"time_ms\":%.3f,\"move\":\"%s\"}\n", i, d, nodes, ms,
+                move.c_str());
+            depth_nodes[d] += nodes;
+            depth_qnodes[d] += logic.qnodes() - qnodes_before;
+            depth_ms[d] += ms;
+            signature.add(nodes);
+            for (const char c : move)
+            {
+                signature.add(uint64_t(c));
+            }
+        }
+    }
+
+    size_t total_nodes = 0;
+    for (int d = 1; d <= depth; ++d)
+    {
+        total_nodes += depth_nodes[d];
+        printf("{\"depth\":%d,\"nodes\":%zu,\"qnodes\":%zu,\"time_ms\":%.3f}\n", d, depth_nodes[d], depth_qnodes[d],
+            depth_ms[d]);
+    }
+    const double total_ms = depth_ms[depth]; // Время до последней глубины включает все предыдущие
+    printf("{\"positions\":%d,\"depth\":%d,\"threads\":%d,\"nodes\":%zu,\"qnodes\":%zu,\"stand_pats\":%zu,"
+        "\"time_ms\":%.3f,\"nps\":%.0f,\"allocations\":%zu,\"signature\":\"%016llx\"}\n", count, depth, threads,
+        total_nodes, logic.qnodes(), logic.stand_pats(), total_ms, total_nodes / max(total_ms, 1e-3) * 1000,
+        allocations, (unsigned long long)signature.value);
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Построение дебютной книги из партий бота с самим собой.
+// Каждая партия начинается из начальной позиции, первые plies ходов бот ищет на глубину depth
+// со случайным выбором среди равных ходов (NoRandom = false). Каждый сыгранный ход записывается
+// в книгу, вес хода - сколько раз перебор его выбрал. Файл отсортирован по хэшу позиции,
+// Logic отображает его в память (настройка BookFile).
+// Перед каждой партией генератор случайных чисел Logic переинициализируется от seed + номер партии,
+// поэтому набор партий воспроизводим при том же seed.
+// Запуск из папки с settings.json: book_gen [партий] [ходов] [глубина] [файл] [seed]
+// (по умолчанию 100, 10, 8, book.bin и 1).
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include "../Game/Logic.h"
+
+int main(int argc, char** argv)
+{
+    const int games = argc > 1 ? atoi(argv[1]) : 100;
+    const int plies = argc > 2 ? atoi(argv[2]) : 10;
+    const int depth = argc > 3 ? atoi(argv[3]) : 8;
+    const string path = argc > 4 ? argv[4] : "book.bin";
+    const unsigned seed = argc > 5 ? unsigned(atoi(argv[5])) : 1;
+
+    Config config;
+    config.set("Bot", "NoRandom", false); // Разные партии за счет случайного выбора среди равных ходов
+    config.set("Bot", "BotTimeMS", 0);
+    config.set("Bot", "BookFile", "");    // Ходы ищутся перебором, а не берутся из старой книги
+    Logic logic(&config);
+
+    // Вес каждой пары (позиция, ход)
+    map<pair<uint64_t, string>, uint32_t> moves;
+    const Position start(string("bbbbbbbbbbbb........wwwwwwwwwwww"));
+    for (int g = 0; g < games; ++g)
+    {
+        logic.new_game(seed + unsigned(g)); // Новый seed и пустая таблица транспозиций для каждой партии
+        Position pos = start;
+        bool color = 0;
+        for (int ply = 0; ply < plies; ++ply)
+        {
+            logic.Max_depth = depth;
+            const auto line = logic.find_best_turns(color, pos);
+            if (line.empty() || int(line.size()) >= BOOK_MAX_PATH)
+                break;
+            string path_squares(1, char(cell_to_sq(line[0].x, line[0].y))); // Клетки хода
+            for (const auto& turn : line)
+            {
+                path_squares.push_back(char(cell_to_sq(turn.x2, turn.y2)));
+            }
+            ++moves[{ zobrist_hash(pos, color, false), path_squares }];
+            for (const auto& turn : line)
+            {
+                pos = pos.make_turn(turn);
+            }
+            color = !color;
+        }
+        printf("game %d of %d\r", g + 1, games);
+        fflush(stdout);
+    }
+
+    // Записи по возрастанию хэша, ходы одной позиции - по убыванию веса
+    vector<BookEntry> entries;
+    for (const auto& item : moves)
+    {
+        BookEntry entry{};
+        entry.key = item.first.first;
+        entry.weight = item.second;
+        entry.length = uint8_t(item.first.second.size());
+        memcpy(entry.path, item.first.second.data(), entry.length);
+        entries.push_back(entry);
+    }
+    stable_sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+    });
+
+    ofstream fout(path, ios::binary | ios::trunc);
+    BookFileHeader header;
+    memcpy(header.magic, BOOK_MAGIC, sizeof(header.magic));
+    header.count = entries.size();
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(entries.data()), streamsize(entries.size() * sizeof(BookEntry)));
+    if (!fout)
+    {
+        printf("\nCan't write %s\n", path.c_str());
+        return 1;
+    }
+    printf("\nWritten %s: %zu moves\n", path.c_str(), entries.size());
+    return 0;
+}
@@ -0,0 +1,424 @@
+// Построение таблиц окончаний ретроградным анализом.
+// Для всех составов фигур с общим числом фигур не больше N (по умолчанию 5) находит результат каждой
+// позиции при ходе белых (выигрыш/проигрыш за d полуходов или ничья) и записывает их в один файл,
+// который Logic отображает в память (настройка EndgameFile). Позиции с ходом черных не хранятся:
+// они равносильны повернутым позициям с ходом белых (Position::flipped).
+// Составы решаются по возрастанию числа фигур, а при равном числе - по возрастанию числа шашек,
+// поэтому позиции после ударов и превращений уже решены. Состав и его зеркальный (цвета поменяны)
+// решаются вместе: тихий ход переводит позицию одного в позицию другого.
+// Внутри пары позиции решаются по уровням: на уровне d позиция выигрывает, если есть ход в проигрыш
+// соперника за d - 1, и проигрывает, если все ходы ведут в выигрыш соперника не дольше d - 1.
+// На уровне d проверяются только предшественники позиций, решенных на уровне d - 1 (обратные тихие ходы),
+// и позиции с ударом или превращением в позицию меньшей таблицы с результатом за d - 1.
+// Нерешенные позиции - ничьи. Результат длиннее ENDGAME_MAX_DISTANCE полуходов в байт не помещается:
+// такие позиции тоже остаются ничьими, но генератор решает еще один уровень за пределом, считает их
+// и печатает предупреждение (итоговое - перед записью файла).
+// Байт на позицию и в памяти, и в файле. На одном ядре: N = 4 - 6.6 млн позиций, ~17 с; N = 5 - 151 млн
+// (151 МБ), ~9 мин; N = 6 - 2.7 млрд (2.7 ГБ), часы. Время делится на количество ядер.
+// Запуск из папки с settings.json: endgame_gen [N] [файл] (по умолчанию 5 и endgame.bin).
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include "../Game/Logic.h"
+
+// Значение позиции для генерации: еще не решена
+const uint8_t UNSOLVED = 255;
+
+// Номер таблицы по составу фигур
+int material_key(const EndgameMaterial& m)
+{
+    return ((m.wm * 16 + m.bm) * 16 + m.wk) * 16 + m.bk;
+}
+
+class EndgameGenerator
+{
+public:
+    EndgameGenerator(Config* config, const int max_pieces) : max_pieces(max_pieces)
+    {
+        const int threads = max(1, int(thread::hardware_concurrency()));
+        for (int i = 0; i < threads; ++i)
+        {
+            logics.push_back(make_unique<Logic>(config)); // Генераторы ходов для каждого потока
+        }
+    }
+
+    // Построение всех таблиц
+    void build()
+    {
+        // Все составы: у каждой стороны хотя бы одна фигура
+        for (int total = 2; total <= max_pieces; ++total)
+        {
+            vector<EndgameMaterial> list;
+            for (int wm = 0; wm <= total; ++wm)
+                for (int bm = 0; wm + bm <= total; ++bm)
+                    for (int wk = 0; wm + bm + wk <= total; ++wk)
+                    {
+                        const int bk = total - wm - bm - wk;
+                        if (wm + wk > 0 && bm + bk > 0)
+                            list.emplace_back(wm, bm, wk, bk);
+                    }
+            stable_sort(list.begin(), list.end(), [](const EndgameMaterial& a, const EndgameMaterial& b) {
+                return a.wm + a.bm < b.wm + b.bm;
+            });
+            for (const auto& m : list)
+            {
+                if (tables.count(material_key(m)))
+                    continue;
+                vector<EndgameMaterial> group{ m };
+                const EndgameMaterial mirror(m.bm, m.wm, m.bk, m.wk);
+                if (material_key(mirror) != material_key(m))
+                    group.push_back(mirror);
+                solve(group);
+            }
+        }
+    }
+
+    // Количество позиций, результат которых длиннее ENDGAME_MAX_DISTANCE и записан ничьей (проверяется
+    // только первый уровень за пределом)
+    size_t truncated_positions() const
+    {
+        return truncated;
+    }
+
+    // Запись таблиц в файл
+    bool write(const string& path) const
+    {
+        ofstream fout(path, ios::binary | ios::trunc);
+        if (!fout)
+            return false;
+        EndgameFileHeader header;
+        memcpy(header.magic, ENDGAME_MAGIC, sizeof(header.magic));
+        header.max_pieces = uint32_t(max_pieces);
+        header.count = uint32_t(order.size());
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t offset = sizeof(header) + order.size() * sizeof(EndgameFileEntry);
+        for (const auto& m : order)
+        {
+            EndgameFileEntry entry;
+            entry.wm = uint8_t(m.wm);
+            entry.bm = uint8_t(m.bm);
+            entry.wk = uint8_t(m.wk);
+            entry.bk = uint8_t(m.bk);
+            entry.reserved = 0;
+            entry.offset = offset;
+            entry.size = m.size();
+            fout.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            offset += entry.size;
+        }
+        for (const auto& m : order)
+        {
+            const auto& table = tables.at(material_key(m));
+            fout.write(reinterpret_cast<const char*>(table.data()), streamsize(table.size()));
+        }
+        return bool(fout);
+    }
+
+private:
+    // Значение позиции с ходом белых из уже построенных или строящихся таблиц
+    uint8_t value(const Position& pos) const
+    {
+        if (!pos.white) // У ходящей стороны не осталось фигур - проигрыш
+            return 2;
+        const EndgameMaterial m(pos);
+        return tables.at(material_key(m))[m.index(pos)];
+    }
+
+    // Позиция решаемой пары составов: номер состава в group_materials и номер позиции в его таблице
+    struct GroupPosition
+    {
+        uint64_t idx;
+        int table;
+
+        bool operator<(const GroupPosition& other) const
+        {
+            return table != other.table ? table < other.table : idx < other.idx;
+        }
+
+        bool operator==(const GroupPosition& other) const
+        {
+            return table == other.table && idx == other.idx;
+        }
+    };
+
+    // Решение состава и его зеркального
+    void solve(const vector<EndgameMaterial>& group)
+    {
+        group_materials = group;
+        group_tables.clear();
+        size_t total = 0;
+        for (const auto& m : group)
+        {
+            vector<uint8_t>& table = tables[material_key(m)];
+            table.assign(m.size(), ENDGAME_INVALID);
+            Position pos;
+            for (uint64_t idx = 0; idx < table.size(); ++idx)
+            {
+                if (m.position(idx, pos))
+                    table[idx] = UNSOLVED;
+            }
+            group_tables.push_back(&table);
+            order.push_back(m);
+            total += table.size();
+        }
+
+        // Первый проход по всем позициям: позиции без ходов проигрывают за 0 полуходов, а ходы в позиции
+        // уже решенных таблиц (удары и превращения) с результатом за e полуходов отмечают уровень e + 1,
+        // на котором позицию нужно проверить
+        const size_t threads = logics.size();
+        vector<vector<GroupPosition>> lost(threads);
+        vector<vector<vector<GroupPosition>>> pending(threads, vector<vector<GroupPosition>>(ENDGAME_MAX_DISTANCE + 2));
+        for (int g = 0; g < int(group.size()); ++g)
+        {
+            const vector<uint8_t>& table = *group_tables[g];
+            parallel(table.size(), [&](const size_t t, const uint64_t idx) {
+                Position pos;
+                if (table[idx] != UNSOLVED || !group[g].position(idx, pos))
+                    return;
+                const auto next = logics[t]->find_full_turns(0, pos);
+                if (next.empty())
+                    lost[t].push_back({ idx, g });
+                for (const auto& after : next)
+                {
+                    const Position flipped = after.flipped();
+                    if (group_table(flipped) >= 0) // Тихий ход: позиция этой же пары, еще не решена
+                        continue;
+                    const uint8_t v = value(flipped);
+                    if (v != ENDGAME_DRAW && v - 2 <= ENDGAME_MAX_DISTANCE)
+                        pending[t][v - 2 + 1].push_back({ idx, g });
+                }
+            });
+        }
+        vector<GroupPosition> frontier; // Позиции, решенные на предыдущем уровне
+        for (const auto& list : lost)
+        {
+            for (const auto& item : list)
+            {
+                (*group_tables[item.table])[item.idx] = 2;
+                frontier.push_back(item);
+            }
+        }
+        size_t solved = frontier.size();
+
+        // Уровни d = 1, 2, ...: результат позиции может появиться на уровне d, только если ее ход ведет
+        // в позицию, решенную на уровне d - 1. Поэтому проверяются лишь предшественники позиций прошлого
+        // уровня (обратные тихие ходы) и позиции, отмеченные первым проходом. Уровень ENDGAME_MAX_DISTANCE + 1
+        // только проверяет, не обрезаны ли результаты: его позиции считаются, но не записываются
+        size_t beyond = 0;
+        for (int d = 1; d <= ENDGAME_MAX_DISTANCE + 1; ++d)
+        {
+            vector<vector<GroupPosition>> found(threads);
+            parallel(frontier.size(), [&](const size_t t, const size_t i) {
+                Position pos;
+                group_materials[frontier[i].table].position(frontier[i].idx, pos);
+                predecessors(pos, found[t]);
+            });
+            vector<GroupPosition> candidates;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                candidates.insert(candidates.end(), found[t].begin(), found[t].end());
+                candidates.insert(candidates.end(), pending[t][d].begin(), pending[t][d].end());
+                found[t].clear();
+                vector<GroupPosition>().swap(pending[t][d]);
+            }
+            sort(candidates.begin(), candidates.end());
+            candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+            vector<vector<pair<GroupPosition, uint8_t>>> results(threads); // Применяются после уровня
+            parallel(candidates.size(), [&](const size_t t, const size_t i) {
+                const GroupPosition& item = candidates[i];
+                Position pos;
+                if ((*group_tables[item.table])[item.idx] != UNSOLVED ||
+                    !group_materials[item.table].position(item.idx, pos))
+                    return;
+                const int res = solve_position(*logics[t], pos, d);
+                if (res >= 0)
+                    results[t].emplace_back(item, uint8_t(res));
+            });
+            if (d > ENDGAME_MAX_DISTANCE)
+            {
+                for (const auto& list : results)
+                {
+                    beyond += list.size();
+                }
+                break;
+            }
+            frontier.clear();
+            for (const auto& list : results)
+            {
+                for (const auto& item : list)
+                {
+                    (*group_tables[item.first.table])[item.first.idx] = item.second;
+                    frontier.push_back(item.first);
+                }
+            }
+            solved += frontier.size();
+            bool more = !frontier.empty(); // Остались решенные позиции или отмеченные уровни
+            for (size_t t = 0; t < threads && !more; ++t)
+            {
+                for (int e = d + 1; e <= ENDGAME_MAX_DISTANCE + 1 && !more; ++e)
+                    more = !pending[t][e].empty();
+            }
+            if (!more)
+                break;
+        }
+        int group_max = 0;
+        for (const auto& m : group)
+        {
+            for (auto& value : tables[material_key(m)])
+            {
+                if (value == UNSOLVED)
+                    value = ENDGAME_DRAW;
+                else if (value != ENDGAME_INVALID && value != ENDGAME_DRAW)
+                    group_max = max(group_max, value - 2);
+            }
+        }
+        max_distance = max(max_distance, group_max);
+        for (const auto& m : group)
+        {
+            printf("wm %d bm %d wk %d bk %d: %zu positions\n", m.wm, m.bm, m.wk, m.bk, size_t(m.size()));
+        }
+        printf("  solved %zu of %zu, longest %d plies\n", solved, total, group_max);
+        if (beyond)
+        {
+            printf("  WARNING: %zu positions win in %d plies (and maybe more in longer ones), stored as draws\n",
+                beyond, ENDGAME_MAX_DISTANCE + 1);
+        }
+        truncated += beyond;
+        fflush(stdout);
+    }
+
+    // Номер состава позиции с ходом белых в решаемой паре или -1
+    int group_table(const Position& pos) const
+    {
+        const int key = material_key(EndgameMaterial(pos));
+        for (int g = 0; g < int(group_materials.size()); ++g)
+        {
+            if (material_key(group_materials[g]) == key)
+                return g;
+        }
+        return -1;
+    }
+
+    // Нерешенные позиции пары, из которых тихим ходом (без удара и превращения) получается позиция solved.
+    // После хода позиция повернута, поэтому в solved.flipped() ходившая сторона - белые: каждая их шашка
+    // пришла на шаг назад (шашки белых ходят к нулевой горизонтали), каждая дамка - с любой клетки
+    // по диагонали через свободные клетки. Лишние позиции (например, с обязательным ударом) допустимы:
+    // их проверяет solve_position
+    void predecessors(const Position& solved, vector<GroupPosition>& out) const
+    {
+        const Position after = solved.flipped();
+        const uint32_t occupied = after.occupied();
+        for (uint32_t pieces = after.white; pieces; pieces &= pieces - 1)
+        {
+            const int to = lsb(pieces);
+            const bool king = (after.kings >> to) & 1;
+            const int x = sq_x(to), y = sq_y(to);
+            for (int dx = -1; dx <= 1; dx += 2)
+            {
+                if (!king && dx < 0)
+                    continue;
+                for (int dy = -1; dy <= 1; dy += 2)
+                {
+                    for (int step = 1; step < 8; ++step)
+                    {
+                        const int fx = x + dx * step, fy = y + dy * step;
+                        if (fx < 0 || fx > 7 || fy < 0 || fy > 7)
+                            break;
+                        const int from = cell_to_sq(POS_T(fx), POS_T(fy));
+                        if ((occupied >> from) & 1)
+                            break;
+                        Position before = after;
+                        before.clear(to);
+                        before.set(from, king ? 3 : 1);
+                        const int g = group_table(before);
+                        const uint64_t idx = group_materials[g].index(before);
+                        if ((*group_tables[g])[idx] == UNSOLVED)
+                            out.push_back({ idx, g });
+                        if (!king)
+                            break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Вызов f(поток, i) для i от 0 до count - 1 на всех потоках
+    template <typename F>
+    void parallel(const size_t count, F f)
+    {
+        const size_t threads = logics.size();
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                for (size_t i = t; i < count; i += threads)
+                {
+                    f(t, i);
+                }
+            });
+        }
+        for (auto& th : workers)
+        {
+            th.join();
+        }
+    }
+
+    // Результат позиции на уровне d (2 + d, на уровне за ENDGAME_MAX_DISTANCE в байт не помещается) или -1
+    int solve_position(Logic& logic, const Position& pos, const int d) const
+    {
+        const auto next = logic.find_full_turns(0, pos);
+        if (next.empty()) // Ходов нет - проигрыш
+            return d == 0 ? 2 : -1;
+        if (d == 0)
+            return -1;
+        bool all_wins = true; // Все ходы ведут в выигрыш соперника не дольше d - 1
+        for (const auto& after : next)
+        {
+            const uint8_t v = value(after.flipped()); // Значение для соперника
+            if (v == 2 + d - 1 && (d - 1) % 2 == 0)
+                return 2 + d; // Есть ход в проигрыш соперника
+            if (v == UNSOLVED || v == ENDGAME_DRAW || (v - 2) % 2 == 0 || v - 2 > d - 1)
+                all_wins = false;
+        }
+        return (all_wins && d % 2 == 0) ? 2 + d : -1;
+    }
+
+    int max_pieces;                          // Наибольшее количество фигур
+    int max_distance = 0;                    // Самый долгий результат в уже решенных таблицах
+    size_t truncated = 0;                    // Позиции с результатом за ENDGAME_MAX_DISTANCE + 1, записанные ничьими
+    vector<unique_ptr<Logic>> logics;        // Генераторы ходов для потоков
+    map<int, vector<uint8_t>> tables;        // Таблицы по составу фигур
+    vector<EndgameMaterial> order;           // Порядок таблиц в файле
+    vector<EndgameMaterial> group_materials; // Решаемая пара составов
+    vector<vector<uint8_t>*> group_tables;   // Их таблицы
+};
+
+int main(int argc, char** argv)
+{
+    const int max_pieces = argc > 1 ? atoi(argv[1]) : 5;
+    const string path = argc > 2 ? argv[2] : "endgame.bin";
+    if (max_pieces < 2 || max_pieces > ENDGAME_MAX_PIECES)
+    {
+        printf("N must be from 2 to %d\n", ENDGAME_MAX_PIECES);
+        return 1;
+    }
+    Config config;
+    config.set("Bot", "EndgameFile", ""); // Генератору старые таблицы не нужны
+    EndgameGenerator generator(&config, max_pieces);
+    generator.build();
+    if (const size_t truncated = generator.truncated_positions())
+    {
+        printf("WARNING: at least %zu positions win in more than %d plies and are stored as draws\n", truncated,
+            ENDGAME_MAX_DISTANCE);
+    }
+    if (!generator.write(path))
+    {
+        printf("Can't write %s\n", path.c_str());
+        return 1;
+    }
+    printf("Written %s\n", path.c_str());
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Архив партий (Game/Record.h): проверка и сводка, партия по номеру, перевод в PDN и обратно.
+// Запуск:
+//   games stats [архив]          - воспроизведение всех партий: количество, ходы, результаты, размер и скорость
+//   games show архив номер       - партия с номером (с 0) в PDN, читается по индексу без прохода по архиву
+//   games export [архив] [pdn]   - все партии архива в PDN (по умолчанию games.pdn)
+//   games import pdn [архив]     - партии из PDN дописываются в архив
+// (архив по умолчанию games.ckg). Архивы пишут игра (настройка RecordFile) и match (параметр record=).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include "../Game/Pdn.h"
+
+using namespace std;
+
+int stats(const string& path)
+{
+    GameReader reader;
+    if (!reader.open(path))
+    {
+        printf("Can't read %s\n", path.c_str());
+        return 1;
+    }
+    const auto start = chrono::steady_clock::now();
+    size_t plies = 0, steps = 0, captures = 0, damaged = 0, results[4] = {};
+    uint32_t hash = 0; // Сумма конечных позиций: совпадает у архивов с одинаковыми партиями
+    for (size_t i = 0; i < reader.size(); ++i)
+    {
+        GameView game;
+        Position last;
+        const bool ok = reader.game(i, game) && replay_game(game, [&](const Position& pos, const move_pos& step,
+            const bool, const bool) {
+            ++steps;
+            captures += step.xb != -1;
+            last = pos.make_turn(step);
+        });
+        if (!ok)
+        {
+            ++damaged;
+            continue;
+        }
+        plies += game.plies;
+        ++results[int(game.result) & 3];
+        hash = hash * 31 + last.white * 7 + last.black * 3 + last.kings;
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    const double bytes = double(reader.data_end() + reader.size() * sizeof(uint64_t));
+    printf("%zu games, %zu damaged, %zu plies (%zu steps, %zu captures)\n", reader.size(), damaged, plies, steps,
+        captures);
+    printf("results: white %zu, black %zu, draw %zu, unfinished %zu\n", results[1], results[2], results[3],
+        results[0]);
+    printf("%.0f bytes, %.2f bytes per ply with headers and index\n", bytes, bytes / max<size_t>(plies, 1));
+    printf("replayed in %.3f s: %.0f games/s, %.0f plies/s, checksum %08x\n", seconds,
+        reader.size() / max(seconds, 1e-9), plies / max(seconds, 1e-9), hash);
+    return damaged ? 1 : 0;
+}
+
+int show(const string& path, const size_t number)
+{
+    GameReader reader;
+    if (!reader.open(path))
+    {
+        printf("Can't read %s\n", path.c_str());
+        return 1;
+    }
+    GameView game;
+    if (!reader.game(number, game))
+    {
+        printf("No game %zu in %s (%zu games)\n", number, path.c_str(), reader.size());
+        return 1;
+    }
+    if (!write_pdn(cout, game, "Game " + to_string(number)))
+    {
+        printf("Game %zu is damaged\n", number);
+        return 1;
+    }
+    return 0;
+}
+
+int export_pdn(const string& path, const string& pdn_path)
+{
+    GameReader reader;
+    if (!reader.open(path))
+    {
+        printf("Can't read %s\n", path.c_str());
+        return 1;
+    }
+    ofstream fout(pdn_path);
+    size_t damaged = 0;
+    for (size_t i = 0; i < reader.size(); ++i)
+    {
+        GameView game;
+        if (!reader.game(i, game) || !write_pdn(fout, game, "Game " + to_string(i)))
+            ++damaged;
+    }
+    if (!fout)
+    {
+        printf("Can't write %s\n", pdn_path.c_str());
+        return 1;
+    }
+    printf("Written %s: %zu games, %zu damaged skipped\n", pdn_path.c_str(), reader.size() - damaged, damaged);
+    return 0;
+}
+
+int import_pdn(const string& pdn_path, const string& path)
+{
+    ifstream fin(pdn_path);
+    if (!fin)
+    {
+        printf("Can't read %s\n", pdn_path.c_str());
+        return 1;
+    }
+    GameWriter writer;
+    if (!writer.open(path))
+    {
+        printf("Can't write %s\n", path.c_str());
+        return 1;
+    }
+    const size_t before = writer.size();
+    PdnReader reader(fin);
+    GameRecord game;
+    string error;
+    size_t skipped = 0;
+    while (reader.next(game, error))
+    {
+        if (!error.empty())
+        {
+            printf("%s\n", error.c_str());
+            ++skipped;
+            continue;
+        }
+        writer.write(game);
+    }
+    const size_t added = writer.size() - before;
+    if (!writer.close())
+    {
+        printf("Can't write %s\n", path.c_str());
+        return 1;
+    }
+    printf("Imported %zu games into %s (%zu skipped)\n", added, path.c_str(), skipped);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const string command = argc > 1 ? argv[1] : "";
+    if (command == "stats")
+        return stats(argc > 2 ? argv[2] : "games.ckg");
+    if (command == "show" && argc > 3)
+        return show(argv[2], size_t(strtoull(argv[3], nullptr, 10)));
+    if (command == "export")
+        return export_pdn(argc > 2 ? argv[2] : "games.ckg", argc > 3 ? argv[3] : "games.pdn");
+    if (command == "import" && argc > 2)
+        return import_pdn(argv[2], argc > 3 ? argv[3] : "games.ckg");
+    printf("Usage: games stats [archive] | show archive number | export [archive] [pdn] | import pdn [archive]\n");
+    return 1;
+}
@@ -0,0 +1,316 @@
+// Матч двух конфигураций бота без окна (без SDL) на всех ядрах.
+// Каждая стартовая позиция (несколько случайных ходов из начальной) играется дважды со сменой цвета.
+// Выводит победы/ничьи/поражения бота A, разницу в рейтинге Эло с 95% доверительным интервалом,
+// отношение правдоподобия SPRT (матч останавливается, когда оно выходит за границы),
+// среднее время и количество узлов на ход каждого бота.
+// Запуск из папки с settings.json: match [параметр=значение ...]
+//   games=1000 threads=0 (0 - по числу ядер) openings=4 (случайных ходов в начале) maxturns=120 seed=1
+//   elo0=0 elo1=5 alpha=0.05 beta=0.05 (гипотезы и ошибки SPRT)
+//   a.config=settings.json a.level=5 a.scoring=... a.net=... (файл весов для a.scoring=NeuralNetwork)
+//   a.weights=... (подобранные веса NumberAndPotential, "" - ручные)
+//   a.opt=... a.qs=0/1 a.seed=... a.tt=16 (то же для b.)
+//   record=... (архив партий Game/Record.h, в который дописываются все партии матча)
+//   stats=... (файл статистики ходов: строка JSON Game/SearchStats.h на каждый ход с полями game, ply и engine)
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "../Game/Logic.h"
+#include "../Game/Record.h"
+
+// Настройки одного бота в матче
+struct Engine
+{
+    string name = "A";                     // Имя бота в выводе и статистике ходов
+    string config_path = "settings.json"; // Файл настроек в формате settings.json
+    int level = 5;                         // Уровень (глубина перебора)
+    unique_ptr<Config> config;             // Настройки с учетом параметров командной строки
+    // Статистика ходов
+    mutex lock;
+    size_t moves = 0;
+    double time_ms = 0;
+    size_t nodes = 0;
+};
+
+// Счет матча со стороны бота A
+struct MatchScore
+{
+    int wins = 0, draws = 0, losses = 0;
+
+    int games() const
+    {
+        return wins + draws + losses;
+    }
+
+    // Средний набранный балл за партию
+    double score() const
+    {
+        return games() ? (wins + 0.5 * draws) / games() : 0.5;
+    }
+
+    // Дисперсия балла одной партии
+    double variance() const
+    {
+        const double s = score();
+        return games() ? (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / games() : 0;
+    }
+};
+
+// Разница в рейтинге Эло по среднему баллу
+double elo(const double score)
+{
+    const double s = min(max(score, 1e-6), 1 - 1e-6);
+    return -400 * log10(1 / s - 1);
+}
+
+// Ожидаемый балл при разнице в рейтинге elo_diff
+double expected_score(const double elo_diff)
+{
+    return 1 / (1 + pow(10, -elo_diff / 400));
+}
+
+// Логарифм отношения правдоподобия гипотез elo1 и elo0 (нормальное приближение)
+double sprt_llr(const MatchScore& ms, const double elo0, const double elo1)
+{
+    const double var = ms.variance();
+    if (var <= 0)
+        return 0;
+    const double s0 = expected_score(elo0), s1 = expected_score(elo1);
+    return (s1 - s0) * (2 * ms.score() * ms.games() - ms.games() * (s0 + s1)) / (2 * var);
+}
+
+// Значение параметра командной строки name=value
+string arg(map<string, string>& args, const string& name, const string& def)
+{
+    const auto it = args.find(name);
+    return it == args.end() ? def : it->second;
+}
+
+// Случайная стартовая позиция: plies случайных полных ходов из начальной позиции
+Position make_opening(Logic& logic, const unsigned seed, const int plies, bool& color)
+{
+    mt19937 rng(seed);
+    while (true)
+    {
+        Position pos(string("bbbbbbbbbbbb........wwwwwwwwwwww"));
+        color = 0;
+        bool ok = true;
+        for (int ply = 0; ply < plies && ok; ++ply)
+        {
+            const auto next = logic.find_full_turns(color, pos);
+            ok = !next.empty();
+            if (ok)
+            {
+                pos = next[rng() % next.size()];
+                color = !color;
+            }
+        }
+        if (ok && !logic.find_full_turns(color, pos).empty())
+            return pos;
+    }
+}
+
+// Партия номер game из позиции start (ходы пишутся в record, строки статистики ходов - в stats, если он задан).
+// Возвращает балл белых: 1 - победа, 0.5 - ничья, 0 - поражение
+double play_game(Logic& white, Engine& white_engine, Logic& black, Engine& black_engine, Position pos, bool color,
+    const int max_turns, GameRecord& record, const int game, string* stats)
+{
+    record.reset(pos, color);
+    for (int turn = 0; turn < max_turns; ++turn)
+    {
+        Logic& logic = color ? black : white;
+        Engine& engine = color ? black_engine : white_engine;
+        if (logic.find_full_turns(color, pos).empty()) // Нет ходов - поражение
+        {
+            record.result = color ? GameResult::WHITE_WINS : GameResult::BLACK_WINS;
+            return color ? 1 : 0;
+        }
+        logic.Max_depth = engine.level;
+        const size_t nodes = logic.nodes();
+        const auto start = chrono::steady_clock::now();
+        const auto line = logic.find_best_turns(color, pos);
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        {
+            lock_guard<mutex> guard(engine.lock);
+            ++engine.moves;
+            engine.time_ms += ms;
+            engine.nodes += logic.nodes() - nodes;
+        }
+        if (stats)
+        {
+            auto line_stats = logic.last_stats().to_json();
+            line_stats["game"] = game;
+            line_stats["ply"] = turn;
+            line_stats["engine"] = engine.name;
+            *stats += line_stats.dump() + "\n";
+        }
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            record.add_step(line[i], i > 0);
+            pos = pos.make_turn(line[i]);
+        }
+        color = !color;
+    }
+    record.result = GameResult::DRAW;
+    return 0.5; // Достигнуто максимальное количество ходов
+}
+
+int main(int argc, char** argv)
+{
+    map<string, string> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string a = argv[i];
+        const size_t eq = a.find('=');
+        if (eq == string::npos)
+        {
+            printf("Unknown argument %s\n", a.c_str());
+            return 1;
+        }
+        args[a.substr(0, eq)] = a.substr(eq + 1);
+    }
+    const int games = stoi(arg(args, "games", "1000"));
+    int threads = stoi(arg(args, "threads", "0"));
+    if (threads <= 0)
+        threads = max(1, int(thread::hardware_concurrency()));
+    const int opening_plies = stoi(arg(args, "openings", "4"));
+    const int max_turns = stoi(arg(args, "maxturns", "120"));
+    const unsigned seed = unsigned(stoul(arg(args, "seed", "1")));
+    const double elo0 = stod(arg(args, "elo0", "0")), elo1 = stod(arg(args, "elo1", "5"));
+    const double alpha = stod(arg(args, "alpha", "0.05")), beta = stod(arg(args, "beta", "0.05"));
+    const double llr_low = log(beta / (1 - alpha)), llr_high = log((1 - beta) / alpha);
+    const string record_path = arg(args, "record", "");
+    GameWriter writer;
+    if (!record_path.empty() && !writer.open(record_path))
+    {
+        printf("Can't write %s\n", record_path.c_str());
+        return 1;
+    }
+    const string stats_path = arg(args, "stats", "");
+    ofstream stats_out;
+    if (!stats_path.empty())
+    {
+        stats_out.open(stats_path, ios_base::trunc);
+        if (!stats_out)
+        {
+            printf("Can't write %s\n", stats_path.c_str());
+            return 1;
+        }
+    }
+
+    Engine engines[2];
+    for (int e = 0; e < 2; ++e)
+    {
+        const string p = e ? "b." : "a.";
+        Engine& engine = engines[e];
+        engine.name = e ? "B" : "A";
+        engine.config_path = arg(args, p + "config", engine.config_path);
+        engine.config = make_unique<Config>(engine.config_path);
+        Config& config = *engine.config;
+        engine.level = stoi(arg(args, p + "level", to_string(engine.level)));
+        if (args.count(p + "scoring"))
+            config.set("Bot", "BotScoringType", args[p + "scoring"]);
+        if (args.count(p + "net"))
+            config.set("Bot", "NetworkFile", args[p + "net"]);
+        if (args.count(p + "weights"))
+            config.set("Bot", "WeightsFile", args[p + "weights"]);
+        if (args.count(p + "opt"))
+            config.set("Bot", "Optimization", args[p + "opt"]);
+        if (args.count(p + "qs"))
+            config.set("Bot", "Quiescence", args[p + "qs"] != "0");
+        if (args.count(p + "seed"))
+            config.set("Bot", "Seed", stoul(args[p + "seed"]));
+        config.set("Bot", "TTSizeMB", stoi(arg(args, p + "tt", "16")));
+        config.set("Bot", "Threads", 1); // Параллельно играются партии, а не ходы
+        config.set("Bot", "BotTimeMS", 0);
+    }
+
+    printf("A: %s level %d, B: %s level %d, %d games on %d threads\n", engines[0].config_path.c_str(),
+        engines[0].level, engines[1].config_path.c_str(), engines[1].level, games, threads);
+    printf("SPRT elo0 %.1f elo1 %.1f, bounds [%.2f, %.2f]\n", elo0, elo1, llr_low, llr_high);
+
+    MatchScore ms;
+    mutex lock;
+    atomic<int> next{ 0 };
+    atomic<bool> stop{ false };
+    string verdict;
+    const auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]() {
+            Logic a(engines[0].config.get()), b(engines[1].config.get());
+            GameRecord record;
+            string stats; // Статистика ходов партии, пишется в файл целиком после партии
+            for (int g = next++; g < games && !stop; g = next++)
+            {
+                bool color;
+                const Position opening = make_opening(a, seed + unsigned(g / 2), opening_plies, color);
+                a.new_game(seed * 7919 + unsigned(g));
+                b.new_game(seed * 7919 + unsigned(g) + 104729);
+                // В четных партиях A играет белыми, в нечетных - черными
+                const bool a_white = g % 2 == 0;
+                string* game_stats = stats_out.is_open() ? &stats : nullptr;
+                stats.clear();
+                const double white_score = a_white ?
+                    play_game(a, engines[0], b, engines[1], opening, color, max_turns, record, g, game_stats) :
+                    play_game(b, engines[1], a, engines[0], opening, color, max_turns, record, g, game_stats);
+                const double a_score = a_white ? white_score : 1 - white_score;
+
+                lock_guard<mutex> guard(lock);
+                if (writer.is_open())
+                    writer.write(record);
+                stats_out << stats;
+                if (a_score == 1)
+                    ++ms.wins;
+                else if (a_score == 0)
+                    ++ms.losses;
+                else
+                    ++ms.draws;
+                const double llr = sprt_llr(ms, elo0, elo1);
+                if (verdict.empty() && llr >= llr_high)
+                    verdict = "H1 accepted (A is stronger by elo1)";
+                if (verdict.empty() && llr <= llr_low)
+                    verdict = "H0 accepted (A is not stronger by elo1)";
+                if (!verdict.empty())
+                    stop = true;
+                printf("games %d: +%d =%d -%d  LLR %.2f\r", ms.games(), ms.wins, ms.draws, ms.losses, llr);
+                fflush(stdout);
+            }
+        });
+    }
+    for (auto& th : workers)
+    {
+        th.join();
+    }
+    const double total_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!writer.close())
+        printf("Can't write %s\n", record_path.c_str());
+    if (stats_out.is_open())
+    {
+        stats_out.close();
+        if (!stats_out)
+            printf("Can't write %s\n", stats_path.c_str());
+    }
+
+    const int n = ms.games();
+    const double s = ms.score(), margin = 1.96 * sqrt(ms.variance() / max(n, 1));
+    printf("\nGames %d (%.1f s): A +%d =%d -%d, score %.3f\n", n, total_s, ms.wins, ms.draws, ms.losses, s);
+    printf("Elo %.1f +- %.1f (95%%: %.1f .. %.1f)\n", elo(s), (elo(s + margin) - elo(s - margin)) / 2,
+        elo(s - margin), elo(s + margin));
+    printf("SPRT LLR %.2f [%.2f, %.2f]: %s\n", sprt_llr(ms, elo0, elo1), llr_low, llr_high,
+        verdict.empty() ? "no decision" : verdict.c_str());
+    for (int e = 0; e < 2; ++e)
+    {
+        const Engine& engine = engines[e];
+        const size_t moves = max<size_t>(engine.moves, 1);
+        printf("%s: %zu moves, %.2f ms and %.0f nodes per move\n", engine.name.c_str(), engine.moves,
+            engine.time_ms / moves, double(engine.nodes) / moves);
+    }
+    return 0;
+}
@@ -0,0 +1,333 @@
+// Обучение нейросети оценки (BotScoringType "NeuralNetwork", Game/Network.h) на оценках перебора.
+// Позиции берутся из партий бота с самим собой: после нескольких случайных ходов из начальной позиции
+// бот играет на глубину depth эвристикой NumberAndPotential, изредка делая случайный ход. Для каждой спокойной
+// позиции (у ходящей стороны нет ударов) запоминается оценка перебора, и сеть учится предсказывать её логарифм
+// по самой позиции, без перебора (со стороны белых, как и Evaluator). Обучение в float (Adam, среднеквадратичная
+// ошибка), затем веса квантуются в целые числа Network и записываются в файл. Десятая часть позиций
+// в обучении не участвует: на ней выводится ошибка эвристики, сети в float и квантованной сети из файла.
+// Запуск из папки с settings.json: nnue_train [позиций] [глубина] [эпох] [файл] [seed]
+// (по умолчанию 20000, 6, 30, network.bin и 1).
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include "../Game/Logic.h"
+
+// Позиция для обучения: номера входов сети для фигур и оценка перебора (логарифм отношения материала белых
+// к материалу черных)
+struct Sample
+{
+    Position pos;
+    vector<int> features;
+    float target = 0;
+};
+
+// Сеть в float с теми же слоями, что и Network (активации ограничены 0..1)
+struct FloatNetwork
+{
+    vector<float> w1 = vector<float>(NN_INPUTS * NN_HIDDEN), b1 = vector<float>(NN_HIDDEN);
+    vector<float> w2 = vector<float>(NN_HIDDEN2 * NN_HIDDEN), b2 = vector<float>(NN_HIDDEN2);
+    vector<float> w3 = vector<float>(NN_HIDDEN2), b3 = vector<float>(1);
+
+    // Все параметры подряд (для оптимизатора)
+    vector<vector<float>*> params()
+    {
+        return { &w1, &b1, &w2, &b2, &w3, &b3 };
+    }
+};
+
+// Промежуточные значения прямого прохода для обратного
+struct Activations
+{
+    float acc[NN_HIDDEN], h1[NN_HIDDEN], z2[NN_HIDDEN2], h2[NN_HIDDEN2];
+    float out = 0;
+};
+
+float clamp01(const float v)
+{
+    return min(max(v, 0.0f), 1.0f);
+}
+
+void forward(const FloatNetwork& net, const vector<int>& features, Activations& a)
+{
+    for (int j = 0; j < NN_HIDDEN; ++j)
+    {
+        a.acc[j] = net.b1[j];
+    }
+    for (const int f : features)
+    {
+        for (int j = 0; j < NN_HIDDEN; ++j)
+        {
+            a.acc[j] += net.w1[f * NN_HIDDEN + j];
+        }
+    }
+    for (int j = 0; j < NN_HIDDEN; ++j)
+    {
+        a.h1[j] = clamp01(a.acc[j]);
+    }
+    a.out = net.b3[0];
+    for (int k = 0; k < NN_HIDDEN2; ++k)
+    {
+        a.z2[k] = net.b2[k];
+        for (int j = 0; j < NN_HIDDEN; ++j)
+        {
+            a.z2[k] += net.w2[k * NN_HIDDEN + j] * a.h1[j];
+        }
+        a.h2[k] = clamp01(a.z2[k]);
+        a.out += net.w3[k] * a.h2[k];
+    }
+}
+
+// Градиент квадрата ошибки (out - target)^2 добавляется к grad
+void backward(const FloatNetwork& net, const vector<int>& features, const Activations& a, const float target,
+    FloatNetwork& grad)
+{
+    const float d_out = 2 * (a.out - target);
+    grad.b3[0] += d_out;
+    float d_h1[NN_HIDDEN] = {};
+    for (int k = 0; k < NN_HIDDEN2; ++k)
+    {
+        grad.w3[k] += d_out * a.h2[k];
+        if (a.z2[k] <= 0 || a.z2[k] >= 1) // Вне 0..1 активация постоянна
+            continue;
+        const float d_z2 = d_out * net.w3[k];
+        grad.b2[k] += d_z2;
+        for (int j = 0; j < NN_HIDDEN; ++j)
+        {
+            grad.w2[k * NN_HIDDEN + j] += d_z2 * a.h1[j];
+            d_h1[j] += d_z2 * net.w2[k * NN_HIDDEN + j];
+        }
+    }
+    for (int j = 0; j < NN_HIDDEN; ++j)
+    {
+        if (a.acc[j] <= 0 || a.acc[j] >= 1)
+            continue;
+        grad.b1[j] += d_h1[j];
+        for (const int f : features)
+        {
+            grad.w1[f * NN_HIDDEN + j] += d_h1[j];
+        }
+    }
+}
+
+// Ограничения весов, при которых квантованные значения помещаются в свои типы: аккумулятор int16
+// при 24 фигурах, веса второго слоя int8 и выходного int16 с масштабом NN_QB
+void clip_weights(FloatNetwork& net)
+{
+    const float w1_max = 7.5f, w2_max = 127.0f / NN_QB, w3_max = 32767.0f / NN_QB;
+    for (auto* p : { &net.w1, &net.b1 })
+        for (auto& v : *p)
+            v = min(max(v, -w1_max), w1_max);
+    for (auto& v : net.w2)
+        v = min(max(v, -w2_max), w2_max);
+    for (auto& v : net.w3)
+        v = min(max(v, -w3_max), w3_max);
+}
+
+// Квантованные веса в формате файла
+unique_ptr<NetworkWeights> quantize(const FloatNetwork& net)
+{
+    auto res = make_unique<NetworkWeights>();
+    for (int f = 0; f < NN_INPUTS; ++f)
+        for (int j = 0; j < NN_HIDDEN; ++j)
+            res->w1[f][j] = int16_t(lround(net.w1[f * NN_HIDDEN + j] * NN_QA));
+    for (int j = 0; j < NN_HIDDEN; ++j)
+    {
+        res->b1[j] = int16_t(lround(net.b1[j] * NN_QA));
+    }
+    for (int k = 0; k < NN_HIDDEN2; ++k)
+    {
+        for (int j = 0; j < NN_HIDDEN; ++j)
+        {
+            res->w2[k][j] = int8_t(lround(net.w2[k * NN_HIDDEN + j] * NN_QB));
+        }
+        res->b2[k] = int32_t(lround(net.b2[k] * NN_QA * NN_QB));
+        res->w3[k] = int16_t(lround(net.w3[k] * NN_QB));
+    }
+    res->b3 = int32_t(lround(net.b3[0] * NN_QA * NN_QB));
+    return res;
+}
+
+// Среднеквадратичная ошибка сети в float на позициях samples
+double float_rmse(const FloatNetwork& net, const vector<Sample>& samples)
+{
+    double sum = 0;
+    Activations a;
+    for (const auto& s : samples)
+    {
+        forward(net, s.features, a);
+        sum += (a.out - s.target) * (a.out - s.target);
+    }
+    return sqrt(sum / max<size_t>(samples.size(), 1));
+}
+
+// Среднеквадратичная ошибка логарифма оценки evaluator (со стороны белых) на позициях samples
+double eval_rmse(const Evaluator& evaluator, const vector<Sample>& samples)
+{
+    double sum = 0;
+    for (const auto& s : samples)
+    {
+        const double v = log(evaluator.score(evaluator.init(s.pos), false)) - s.target;
+        sum += v * v;
+    }
+    return sqrt(sum / max<size_t>(samples.size(), 1));
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? size_t(atoi(argv[1])) : 20000;
+    const int depth = argc > 2 ? atoi(argv[2]) : 6;
+    const int epochs = argc > 3 ? atoi(argv[3]) : 30;
+    const string path = argc > 4 ? argv[4] : "network.bin";
+    const unsigned seed = argc > 5 ? unsigned(atoi(argv[5])) : 1;
+
+    Config config;
+    config.set("Bot", "NoRandom", false);  // Разные партии за счет случайного выбора среди равных ходов
+    config.set("Bot", "BotTimeMS", 0);
+    config.set("Bot", "BotScoringType", "NumberAndPotential"); // Учитель - перебор с эвристикой
+    config.set("Bot", "Threads", 1);
+    config.set("Bot", "BookFile", "");
+    config.set("Bot", "EndgameFile", "");
+    Logic logic(&config);
+    mt19937 rng(seed);
+
+    // Позиции из партий бота с самим собой
+    vector<Sample> samples;
+    const Position start(string("bbbbbbbbbbbb........wwwwwwwwwwww"));
+    while (samples.size() < count)
+    {
+        Position pos = start;
+        bool color = 0;
+        logic.new_game(unsigned(rng()));
+        const int opening = 2 + int(rng() % 7); // Случайные ходы в начале партии
+        for (int ply = 0; ply < 120 && samples.size() < count; ++ply)
+        {
+            const auto next = logic.find_full_turns(color, pos);
+            if (next.empty())
+                break;
+            if (ply < opening || rng() % 10 == 0)
+            {
+                pos = next[rng() % next.size()];
+                color = !color;
+                continue;
+            }
+            logic.Max_depth = depth;
+            const auto line = logic.find_best_turns(color, pos);
+            if (line.empty())
+                break;
+            logic.find_turns(color, pos);
+            const double score = logic.root_score();
+            if (!logic.have_beats && score > 1e-3 && score < 1e3) // Спокойная позиция с нерешенным исходом
+            {
+                Sample s;
+                s.pos = pos;
+                for (uint32_t occ = pos.occupied(); occ; occ &= occ - 1)
+                {
+                    s.features.push_back(nn_feature(pos.at(lsb(occ)), lsb(occ)));
+                }
+                s.target = float(color ? -log(score) : log(score)); // Оценка перебора - со стороны ходившего
+                samples.push_back(s);
+            }
+            for (const auto& turn : line)
+            {
+                pos = pos.make_turn(turn);
+            }
+            color = !color;
+        }
+        printf("positions %zu of %zu\r", samples.size(), count);
+        fflush(stdout);
+    }
+    shuffle(samples.begin(), samples.end(), rng);
+    const vector<Sample> test(samples.begin(), samples.begin() + samples.size() / 10);
+    vector<Sample> train(samples.begin() + samples.size() / 10, samples.end());
+    printf("\n%zu training and %zu test positions\n", train.size(), test.size());
+
+    // Начальные веса: первый слой в середине активации, чтобы градиент шел через все нейроны
+    FloatNetwork net;
+    normal_distribution<float> w1_init(0, 0.1f), w2_init(0, 0.3f), w3_init(0, 0.5f);
+    for (auto& v : net.w1)
+        v = w1_init(rng);
+    for (auto& v : net.b1)
+        v = 0.5f;
+    for (auto& v : net.w2)
+        v = w2_init(rng);
+    for (auto& v : net.b2)
+        v = 0.5f;
+    for (auto& v : net.w3)
+        v = w3_init(rng);
+
+    // Adam по мини-пакетам
+    const int batch = 256;
+    const float lr = 1e-3f, beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+    FloatNetwork m, v, grad;
+    for (auto* p : m.params())
+        fill(p->begin(), p->end(), 0.0f);
+    for (auto* p : v.params())
+        fill(p->begin(), p->end(), 0.0f);
+    int step = 0;
+    for (int epoch = 1; epoch <= epochs; ++epoch)
+    {
+        shuffle(train.begin(), train.end(), rng);
+        for (size_t first = 0; first < train.size(); first += batch)
+        {
+            for (auto* p : grad.params())
+                fill(p->begin(), p->end(), 0.0f);
+            const size_t last = min(first + batch, train.size());
+            Activations a;
+            for (size_t i = first; i < last; ++i)
+            {
+                forward(net, train[i].features, a);
+                backward(net, train[i].features, a, train[i].target, grad);
+            }
+            ++step;
+            const float scale = 1.0f / float(last - first);
+            const float c1 = 1 - pow(beta1, float(step)), c2 = 1 - pow(beta2, float(step));
+            const auto params = net.params(), ms = m.params(), vs = v.params(), gs = grad.params();
+            for (size_t p = 0; p < params.size(); ++p)
+            {
+                for (size_t i = 0; i < params[p]->size(); ++i)
+                {
+                    const float g = (*gs[p])[i] * scale;
+                    float& mi = (*ms[p])[i];
+                    float& vi = (*vs[p])[i];
+                    mi = beta1 * mi + (1 - beta1) * g;
+                    vi = beta2 * vi + (1 - beta2) * g * g;
+                    (*params[p])[i] -= lr * (mi / c1) / (sqrt(vi / c2) + eps);
+                }
+            }
+            clip_weights(net);
+        }
+        printf("epoch %d: train rmse %.4f, test rmse %.4f\n", epoch, float_rmse(net, train), float_rmse(net, test));
+        fflush(stdout);
+    }
+
+    const auto weights = quantize(net);
+    ofstream fout(path, ios::binary | ios::trunc);
+    NetworkFileHeader header{};
+    memcpy(header.magic, NETWORK_MAGIC, sizeof(header.magic));
+    header.inputs = NN_INPUTS;
+    header.hidden = NN_HIDDEN;
+    header.hidden2 = NN_HIDDEN2;
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(weights.get()), sizeof(NetworkWeights));
+    fout.close();
+    if (!fout)
+    {
+        printf("Can't write %s\n", path.c_str());
+        return 1;
+    }
+
+    // Проверка на отложенных позициях: эвристика без перебора, сеть в float и сеть из записанного файла
+    const Evaluator heuristic("NumberAndPotential"), neural("NeuralNetwork", path);
+    if (!neural.neural())
+    {
+        printf("Can't load %s\n", path.c_str());
+        return 1;
+    }
+    printf("Test rmse of log score: NumberAndPotential %.4f, float network %.4f, quantized network %.4f\n",
+        eval_rmse(heuristic, test), float_rmse(net, test), eval_rmse(neural, test));
+    printf("Written %s\n", path.c_str());
+    return 0;
+}
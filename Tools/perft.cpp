@@ -0,0 +1,171 @@
+// Perft - проверка и замер скорости генератора ходов.
+// Считает количество позиций на глубине depth полных ходов от заданной позиции (серия ударов - один ход,
+// разные серии одной фигуры считаются разными ходами, даже если ведут в одну позицию).
+// Ходы ищутся публичными функциями Logic::find_turns для игрока и для фигуры (продолжение серии ударов).
+// Запуск из папки с settings.json:
+//   perft                         - проверка всех эталонных позиций (код возврата 1 при расхождении)
+//   perft глубина                 - то же, но только до заданной глубины
+//   perft глубина позиция очередь - разбивка по ходам из корня (divide), позиция в формате Position::to_string,
+//                                   очередь хода 0 - белые, 1 - черные
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../Game/Logic.h"
+#include "Positions.h"
+
+// Эталонная позиция: количество позиций на глубинах 1..depth
+struct PerftPosition {
+    const char* board; // Позиция
+    bool color;        // Очередь хода (0 - белые, 1 - черные)
+    int depth;         // Глубина последнего эталонного значения
+    uint64_t nodes[8]; // Количество позиций на глубинах 1..depth
+};
+
+// Значения проверены независимым переборным генератором по матрице 8x8. Позиции взяты из случайных партий:
+// середины игры из Positions.h, удары дамками через всю доску, превращение шашки посреди серии ударов.
+const PerftPosition perft_positions[] = {
+    { "bbbbbbbbbbbb........wwwwwwwwwwww", 0, 8, { 7, 49, 302, 1469, 7482, 37986, 190146, 929984 } },
+    { "bb.bbb.wb..bw.......ww..w..ww...", 1, 8, { 2, 8, 48, 158, 693, 2423, 10878, 40893 } },
+    { "b.bbbb.....b...w...w....wwwbw.ww", 1, 8, { 1, 7, 40, 170, 999, 5285, 29723, 161106 } },
+    { ".b.bbb.b...b.Bw.w.......w.......", 0, 8, { 1, 5, 21, 91, 423, 1682, 8941, 37016 } },
+    { ".W.b....b....b..b....ww.......w.", 0, 8, { 2, 4, 27, 90, 615, 1814, 13543, 39248 } },
+    { ".b..b.....bW.b.....www.w.w..w.B.", 1, 7, { 8, 55, 256, 1338, 6456, 33154, 170931 } },
+    { "....b.b.bbbW..B.w..w........w...", 1, 7, { 10, 56, 304, 1901, 10410, 58061, 340369 } },
+    { "b...wb..W.b.w..............wwwB.", 1, 7, { 9, 29, 178, 1197, 7599, 52867, 331783 } },
+    { "bW...b.bb.......W............B..", 0, 6, { 13, 110, 695, 5512, 37988, 314053 } },
+    { "...bb..b..bb.bB...W.............", 0, 8, { 4, 20, 138, 628, 3767, 17358, 97496, 458199 } },
+};
+
+class Perft
+{
+public:
+    explicit Perft(Logic& logic) : logic(logic)
+    {
+    }
+
+    // Количество позиций на глубине depth полных ходов игрока color из позиции pos
+    uint64_t count(const Position& pos, const bool color, const int depth)
+    {
+        if (depth == 0)
+            return 1;
+        logic.find_turns(color, pos);
+        const auto turns_now = logic.turns;
+        const bool have_beats_now = logic.have_beats;
+        uint64_t res = 0;
+        for (const auto& turn : turns_now)
+        {
+            res += have_beats_now ? count_beats(pos.make_turn(turn), color, turn.x2, turn.y2, depth) :
+                count(pos.make_turn(turn), !color, depth - 1);
+        }
+        return res;
+    }
+
+    // Разбивка по ходам из корня: название хода и количество позиций после него
+    vector<pair<string, uint64_t>> divide(const Position& pos, const bool color, const int depth)
+    {
+        vector<pair<string, uint64_t>> res;
+        logic.find_turns(color, pos);
+        const auto turns_now = logic.turns;
+        const bool have_beats_now = logic.have_beats;
+        for (const auto& turn : turns_now)
+        {
+            const string from = cell_name(turn.x, turn.y);
+            const Position next = pos.make_turn(turn);
+            if (have_beats_now)
+                divide_beats(next, color, turn.x2, turn.y2, depth, from + ":" + cell_name(turn.x2, turn.y2), res);
+            else
+                res.emplace_back(from + "-" + cell_name(turn.x2, turn.y2), count(next, !color, depth - 1));
+        }
+        sort(res.begin(), res.end());
+        return res;
+    }
+
+private:
+    // Продолжение серии ударов фигурой на клетке (x, y); после серии ход переходит к сопернику
+    uint64_t count_beats(const Position& pos, const bool color, const POS_T x, const POS_T y, const int depth)
+    {
+        logic.find_turns(x, y, pos);
+        if (!logic.have_beats)
+            return count(pos, !color, depth - 1);
+        const auto turns_now = logic.turns;
+        uint64_t res = 0;
+        for (const auto& turn : turns_now)
+        {
+            res += count_beats(pos.make_turn(turn), color, turn.x2, turn.y2, depth);
+        }
+        return res;
+    }
+
+    // Продолжение серии ударов из корня с накоплением названия хода
+    void divide_beats(const Position& pos, const bool color, const POS_T x, const POS_T y, const int depth,
+        const string& name, vector<pair<string, uint64_t>>& res)
+    {
+        logic.find_turns(x, y, pos);
+        if (!logic.have_beats)
+        {
+            res.emplace_back(name, count(pos, !color, depth - 1));
+            return;
+        }
+        const auto turns_now = logic.turns;
+        for (const auto& turn : turns_now)
+        {
+            divide_beats(pos.make_turn(turn), color, turn.x2, turn.y2, depth, name + ":" + cell_name(turn.x2, turn.y2),
+                res);
+        }
+    }
+
+    Logic& logic; // Генератор ходов
+};
+
+// Проверка эталонных позиций до глубины max_depth. Возвращает количество расхождений
+int check(Perft& perft, const int max_depth)
+{
+    int errors = 0;
+    uint64_t total_nodes = 0;
+    double total_ms = 0;
+    printf("%-34s %5s %14s %14s %10s %8s\n", "position", "depth", "nodes", "expected", "ms", "knps");
+    for (const auto& pp : perft_positions)
+    {
+        const Position pos{ string(pp.board) };
+        for (int depth = 1; depth <= min(pp.depth, max_depth); ++depth)
+        {
+            const auto start = chrono::steady_clock::now();
+            const uint64_t nodes = perft.count(pos, pp.color, depth);
+            const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            const uint64_t expected = pp.nodes[depth - 1];
+            total_nodes += nodes;
+            total_ms += ms;
+            printf("%s %d %5d %14llu %14llu %10.1f %8.0f%s\n", pp.board, int(pp.color), depth,
+                (unsigned long long)nodes, (unsigned long long)expected, ms, nodes / max(ms, 1e-3),
+                nodes == expected ? "" : "  MISMATCH");
+            errors += nodes != expected;
+        }
+    }
+    printf("total %llu nodes in %.1f ms, %.0f knps, %d mismatches\n", (unsigned long long)total_nodes, total_ms,
+        total_nodes / max(total_ms, 1e-3), errors);
+    return errors;
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    Logic logic(&config);
+    Perft perft(logic);
+    if (argc <= 2)
+        return check(perft, argc > 1 ? atoi(argv[1]) : 8) ? 1 : 0;
+
+    const int depth = max(1, atoi(argv[1]));
+    const Position pos{ string(argv[2]) };
+    const bool color = argc > 3 && atoi(argv[3]) != 0;
+    const auto start = chrono::steady_clock::now();
+    uint64_t total = 0;
+    for (const auto& item : perft.divide(pos, color, depth))
+    {
+        printf("%-24s %llu\n", item.first.c_str(), (unsigned long long)item.second);
+        total += item.second;
+    }
+    const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    printf("depth %d: %llu nodes in %.1f ms, %.0f knps\n", depth, (unsigned long long)total, ms,
+        total / max(ms, 1e-3));
+    return 0;
+}
@@ -0,0 +1,38 @@
+// Бенчмарк масштабирования многопоточного перебора.
+// Для 1, 2, 4, 8 и 16 потоков ищет лучший ход во всех позициях из Positions.h на фиксированную глубину
+// и выводит время, число узлов и ускорение относительно одного потока.
+// Запуск из папки с settings.json: scaling_bench [глубина] (по умолчанию 10).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../Game/Logic.h"
+#include "Positions.h"
+
+int main(int argc, char** argv)
+{
+    const int depth = argc > 1 ? atoi(argv[1]) : 10;
+    Config config;
+    config.set("Bot", "NoRandom", true); // Одинаковые ходы при любом числе потоков
+    config.set("Bot", "BotTimeMS", 0);   // Перебор на фиксированную глубину
+
+    printf("depth %d, %d positions\n", depth, int(sizeof(bench_positions) / sizeof(bench_positions[0])));
+    printf("%8s %12s %14s %12s %8s\n", "threads", "time_ms", "nodes", "knps", "speedup");
+    double base_ms = 0;
+    for (const int threads : { 1, 2, 4, 8, 16 })
+    {
+        config.set("Bot", "Threads", threads);
+        Logic logic(&config); // Новая таблица транспозиций для каждого числа потоков
+        logic.Max_depth = depth;
+        const auto start = chrono::steady_clock::now();
+        for (const auto& bp : bench_positions)
+        {
+            logic.find_best_turns(bp.color, Position(string(bp.board)));
+        }
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (threads == 1)
+            base_ms = ms;
+        printf("%8d %12.1f %14zu %12.1f %8.2f\n", threads, ms, logic.nodes(), logic.nodes() / max(ms, 1e-3),
+            base_ms / max(ms, 1e-3));
+    }
+    return 0;
+}
@@ -0,0 +1,214 @@
+// Подбор весов оценки "NumberAndPotential" (EvalWeights) по корпусу партий бота с самим собой (Tools/tune_gen.cpp)
+// методом Texel. Модель: вероятность победы белых p = 1 / (1 + exp(-K * ln(W / B))), где W и B - суммы весов
+// фигур белых и черных (ln(W / B) - логарифм оценки Evaluator со стороны белых). Ошибка - средний квадрат
+// p - r по всем позициям, r - результат партии (1, 0.5 или 0). Сначала для ручных весов подбирается K,
+// затем веса - градиентным спуском (Adam по логарифмам весов, поэтому веса остаются положительными).
+// Результат партии зависит от позиции и через то, что выигрывающая сторона продвигает шашки и проводит дамки,
+// поэтому без ограничений подбор завышает продвинутые шашки и бот играет слабее. Штраф lambda * (ln w - ln w0)^2
+// держит веса рядом с ручными w0 и оставляет только устойчивые поправки.
+// Каждая итерация - полный проход по корпусу на всех потоках: записи читаются из отображенного в память файла
+// блоками, признаки (фигуры по горизонталям) считаются подсчетом битов на лету, поэтому память не зависит
+// от размера корпуса. Результат - целые веса (шашка на первой горизонтали - 100) в файле JSON для настройки
+// WeightsFile.
+// Запуск: tune [корпус] [файл весов] [итераций] [потоков] [lambda]
+// (по умолчанию corpus.bin, weights.json, 300, 0 - по числу ядер и 0.01).
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "../Game/Logic.h"
+#include "Corpus.h"
+
+// Количество весов: шашка по пройденным горизонталям (8) и дамка
+const int WEIGHTS = 9;
+// Записей в блоке, который поток берет за раз
+const size_t CHUNK = 1 << 16;
+
+// Сумма ошибки и её градиента по весам за проход по корпусу
+struct Totals
+{
+    double loss = 0;
+    double grad[WEIGHTS] = {};
+    size_t count = 0;
+};
+
+// Количество фигур цвета color по весам: шашки по пройденным горизонталям, последний элемент - дамки
+void features(const CorpusRecord& record, const bool color, int* res)
+{
+    const uint32_t pieces = color ? record.black : record.white, men = pieces & ~record.kings;
+    for (POS_T x = 0; x < 8; ++x)
+    {
+        res[man_advance(color, x)] = popcount(men & row_mask(x));
+    }
+    res[WEIGHTS - 1] = popcount(pieces & record.kings);
+}
+
+// Проход по корпусу с весами w и коэффициентом k на threads потоках
+Totals evaluate(const CorpusReader& corpus, const double* w, const double k, const int threads)
+{
+    atomic<size_t> next{ 0 };
+    vector<Totals> parts(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            Totals& part = parts[t];
+            for (size_t first = next.fetch_add(CHUNK); first < corpus.size(); first = next.fetch_add(CHUNK))
+            {
+                const size_t last = min(first + CHUNK, corpus.size());
+                for (size_t i = first; i < last; ++i)
+                {
+                    const CorpusRecord record = corpus.record(i);
+                    int fw[WEIGHTS], fb[WEIGHTS];
+                    features(record, 0, fw);
+                    features(record, 1, fb);
+                    double sw = 0, sb = 0;
+                    for (int j = 0; j < WEIGHTS; ++j)
+                    {
+                        sw += w[j] * fw[j];
+                        sb += w[j] * fb[j];
+                    }
+                    if (sw <= 0 || sb <= 0) // Партия уже закончена
+                        continue;
+                    const double p = 1 / (1 + exp(-k * log(sw / sb))), r = record.result / 2.0;
+                    part.loss += (p - r) * (p - r);
+                    ++part.count;
+                    const double g = 2 * (p - r) * p * (1 - p) * k; // Производная ошибки по ln(W / B)
+                    for (int j = 0; j < WEIGHTS; ++j)
+                    {
+                        part.grad[j] += g * (fw[j] / sw - fb[j] / sb);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& th : workers)
+    {
+        th.join();
+    }
+    Totals res;
+    for (const auto& part : parts)
+    {
+        res.loss += part.loss;
+        res.count += part.count;
+        for (int j = 0; j < WEIGHTS; ++j)
+        {
+            res.grad[j] += part.grad[j];
+        }
+    }
+    const double n = double(max<size_t>(res.count, 1));
+    res.loss /= n;
+    for (auto& g : res.grad)
+        g /= n;
+    return res;
+}
+
+// Веса в массиве для подбора
+void unpack(const EvalWeights& weights, double* w)
+{
+    for (int j = 0; j < 8; ++j)
+    {
+        w[j] = weights.man[j];
+    }
+    w[WEIGHTS - 1] = weights.king;
+}
+
+// Целые веса: масштаб выбирается так, чтобы шашка на первой горизонтали весила 100
+EvalWeights pack(const double* w)
+{
+    EvalWeights res;
+    for (int j = 0; j < 8; ++j)
+    {
+        res.man[j] = max(1, int(lround(w[j] / w[0] * 100)));
+    }
+    res.king = max(1, int(lround(w[WEIGHTS - 1] / w[0] * 100)));
+    return res;
+}
+
+int main(int argc, char** argv)
+{
+    const string corpus_path = argc > 1 ? argv[1] : "corpus.bin";
+    const string path = argc > 2 ? argv[2] : "weights.json";
+    const int iterations = argc > 3 ? atoi(argv[3]) : 300;
+    int threads = argc > 4 ? atoi(argv[4]) : 0;
+    if (threads <= 0)
+        threads = max(1, int(thread::hardware_concurrency()));
+    const double lambda = argc > 5 ? atof(argv[5]) : 0.01;
+
+    CorpusReader corpus;
+    if (!corpus.open(corpus_path))
+    {
+        printf("Can't read %s\n", corpus_path.c_str());
+        return 1;
+    }
+    printf("%zu positions, %d threads\n", corpus.size(), threads);
+    const auto start = chrono::steady_clock::now();
+
+    // K для ручных весов: ошибка унимодальна по K, поэтому поиск золотым сечением
+    double w[WEIGHTS];
+    unpack(EvalWeights::hand_picked("NumberAndPotential"), w);
+    double lo = 0.05, hi = 20;
+    const double phi = (sqrt(5.0) - 1) / 2;
+    while (hi - lo > 1e-3)
+    {
+        const double k1 = hi - phi * (hi - lo), k2 = lo + phi * (hi - lo);
+        if (evaluate(corpus, w, k1, threads).loss < evaluate(corpus, w, k2, threads).loss)
+            hi = k2;
+        else
+            lo = k1;
+    }
+    const double k = (lo + hi) / 2;
+    const double hand_loss = evaluate(corpus, w, k, threads).loss;
+    printf("K %.4f, hand-picked weights loss %.6f\n", k, hand_loss);
+
+    // Adam по логарифмам весов: d(ошибка)/d(ln w) = w * d(ошибка)/dw, плюс производная штрафа
+    double theta[WEIGHTS], theta0[WEIGHTS], m[WEIGHTS] = {}, v[WEIGHTS] = {};
+    for (int j = 0; j < WEIGHTS; ++j)
+    {
+        theta[j] = theta0[j] = log(w[j]);
+    }
+    const double lr = 0.01, beta1 = 0.9, beta2 = 0.999, eps = 1e-12;
+    for (int it = 1; it <= iterations; ++it)
+    {
+        for (int j = 0; j < WEIGHTS; ++j)
+        {
+            w[j] = exp(theta[j]);
+        }
+        const Totals totals = evaluate(corpus, w, k, threads);
+        for (int j = 0; j < WEIGHTS; ++j)
+        {
+            const double g = totals.grad[j] * w[j] + 2 * lambda * (theta[j] - theta0[j]);
+            m[j] = beta1 * m[j] + (1 - beta1) * g;
+            v[j] = beta2 * v[j] + (1 - beta2) * g * g;
+            theta[j] -= lr * (m[j] / (1 - pow(beta1, it))) / (sqrt(v[j] / (1 - pow(beta2, it))) + eps);
+        }
+        if (it % 25 == 0 || it == iterations)
+        {
+            printf("iteration %d: loss %.6f\n", it, totals.loss);
+            fflush(stdout);
+        }
+    }
+    for (int j = 0; j < WEIGHTS; ++j)
+    {
+        w[j] = exp(theta[j]);
+    }
+
+    const EvalWeights tuned = pack(w);
+    double tuned_w[WEIGHTS];
+    unpack(tuned, tuned_w);
+    const double tuned_loss = evaluate(corpus, tuned_w, k, threads).loss;
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("Tuned weights loss %.6f (hand-picked %.6f), %.1f s\n", tuned_loss, hand_loss, seconds);
+    printf("Man:");
+    for (const int value : tuned.man)
+        printf(" %d", value);
+    printf(", King: %d\n", tuned.king);
+    if (!tuned.save(path))
+    {
+        printf("Can't write %s\n", path.c_str());
+        return 1;
+    }
+    printf("Written %s\n", path.c_str());
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Корпус позиций для подбора весов оценки (Tools/tune.cpp): партии бота с самим собой на всех ядрах.
+// Каждая партия начинается несколькими случайными ходами из начальной позиции, дальше бот играет
+// на глубину depth со случайным выбором среди равных ходов. Все спокойные позиции партии (у ходящей стороны
+// нет ударов) после случайных ходов записываются в корпус с результатом партии: поражение стороны без ходов
+// или ничья после maxturns полуходов. Записи пишутся по мере окончания партий (Tools/Corpus.h).
+// Запуск из папки с settings.json: tune_gen [партий] [глубина] [потоков] [файл] [seed]
+// (по умолчанию 10000, 4, 0 - по числу ядер, corpus.bin и 1).
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "../Game/Logic.h"
+#include "Corpus.h"
+
+int main(int argc, char** argv)
+{
+    const int games = argc > 1 ? atoi(argv[1]) : 10000;
+    const int depth = argc > 2 ? atoi(argv[2]) : 4;
+    int threads = argc > 3 ? atoi(argv[3]) : 0;
+    if (threads <= 0)
+        threads = max(1, int(thread::hardware_concurrency()));
+    const string path = argc > 4 ? argv[4] : "corpus.bin";
+    const unsigned seed = argc > 5 ? unsigned(atoi(argv[5])) : 1;
+
+    Config config;
+    config.set("Bot", "NoRandom", false); // Разные партии за счет случайного выбора среди равных ходов
+    config.set("Bot", "BotTimeMS", 0);
+    config.set("Bot", "Threads", 1);      // Параллельно играются партии, а не ходы
+    config.set("Bot", "TTSizeMB", 16);
+    config.set("Bot", "BookFile", "");
+    const int max_turns = config("Game", "MaxNumTurns");
+
+    CorpusWriter writer;
+    if (!writer.open(path))
+    {
+        printf("Can't write %s\n", path.c_str());
+        return 1;
+    }
+    mutex lock;
+    atomic<int> next{ 0 };
+    int finished = 0;
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]() {
+            Logic logic(&config);
+            vector<CorpusRecord> records; // Позиции текущей партии (результат известен только в конце)
+            for (int g = next++; g < games; g = next++)
+            {
+                mt19937 rng(seed * 7919 + unsigned(g));
+                logic.new_game(unsigned(rng()));
+                records.clear();
+                Position pos(string("bbbbbbbbbbbb........wwwwwwwwwwww"));
+                bool color = 0;
+                const int opening = 4 + int(rng() % 5);
+                uint8_t result = 1; // Ничья, если партия дошла до предела ходов
+                for (int ply = 0; ply < max_turns; ++ply)
+                {
+                    const auto next_positions = logic.find_full_turns(color, pos);
+                    if (next_positions.empty()) // Нет ходов - поражение
+                    {
+                        result = color ? 2 : 0;
+                        break;
+                    }
+                    if (ply < opening)
+                    {
+                        pos = next_positions[rng() % next_positions.size()];
+                        color = !color;
+                        continue;
+                    }
+                    logic.find_turns(color, pos);
+                    if (!logic.have_beats)
+                    {
+                        records.push_back({ pos.white, pos.black, pos.kings, 0, uint8_t(color), uint16_t(ply) });
+                    }
+                    logic.Max_depth = depth;
+                    for (const auto& turn : logic.find_best_turns(color, pos))
+                    {
+                        pos = pos.make_turn(turn);
+                    }
+                    color = !color;
+                }
+
+                lock_guard<mutex> guard(lock);
+                for (auto& record : records)
+                {
+                    record.result = result;
+                    writer.write(record);
+                }
+                printf("games %d of %d, positions %llu\r", ++finished, games, (unsigned long long)writer.size());
+                fflush(stdout);
+            }
+        });
+    }
+    for (auto& th : workers)
+    {
+        th.join();
+    }
+    if (!writer.close())
+    {
+        printf("\nCan't write %s\n", path.c_str());
+        return 1;
+    }
+    printf("\nWritten %s: %llu positions\n", path.c_str(), (unsigned long long)writer.size());
+    return 0;
+}